@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+#include "MyMapAllocator.hpp"
+
+namespace my_allocator {
+
+    /**
+     * @brief std::pmr::memory_resource backed by an Arena.
+     *
+     * Lets pmr containers (std::pmr::map, std::pmr::string,
+     * std::pmr::vector, ...) use the same arena growth strategy and
+     * policy resources as MyMapAllocator without templating container
+     * types on the allocator.
+     *
+     * Policies declaring a nested `resource` type route allocation and
+     * deallocation through it, so freed memory is reused exactly as with
+     * MyMapAllocator. Monotonic policies allocate from the arena
+     * directly.
+     *
+     * Since pmr requests carry no element type, Policy::initial is
+     * interpreted in bytes and logical element limits (Policy::max)
+     * are not enforced.
+     *
+     * @tparam Policy Compile-time configuration type
+     *
+     * @note Not thread-safe.
+     */
+    template<typename Policy = policy::Expandable<>>
+    class ArenaResource : public std::pmr::memory_resource
+    {
+        using Arena    = detail::Arena;
+        using Resource = detail::policy_resource_t<Policy>;
+
+        static constexpr bool HasResource = !std::is_void_v<Resource>;
+
+        /// Dummy member type for monotonic policies
+        struct NoResource
+        {
+            explicit NoResource(Arena&) noexcept {}
+        };
+
+        using Storage = std::conditional_t<HasResource, Resource, NoResource>;
+
+    public:
+        /**
+         * @brief Constructs resource with the policy's upstream source.
+         *
+         * Initial arena capacity is Policy::initial bytes.
+         */
+        ArenaResource()
+                : ArenaResource(detail::policy_upstream<Policy>())
+        {}
+
+        /**
+         * @brief Constructs resource on top of an explicit memory source.
+         *
+         * @param upstream Source of arena blocks; must outlive the resource.
+         */
+        explicit ArenaResource(std::pmr::memory_resource* upstream)
+                : arena_(Policy::initial, 0, upstream)
+                , resource_(arena_)
+        {
+            detail::configure_arena<Policy>(arena_);
+        }
+
+        ArenaResource(const ArenaResource&) = delete;
+        ArenaResource& operator=(const ArenaResource&) = delete;
+
+        /// Access to the underlying arena
+        const Arena& arena() const noexcept
+        {
+            return arena_;
+        }
+
+        /**
+         * @brief Access to the policy resource.
+         *
+         * Allows querying resource-specific statistics
+         * (e.g. slab occupancy).
+         */
+        const auto& resource() const noexcept
+            requires HasResource
+        {
+            return resource_;
+        }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (bytes > detail::Arena::max_request(alignment))
+                throw std::bad_alloc{};
+
+            if constexpr (HasResource)
+                return resource_.allocate(bytes, alignment);
+            else
+                return arena_.allocate_bytes(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            if constexpr (HasResource)
+                resource_.deallocate(p, bytes, alignment);
+            else
+                arena_.deallocate_bytes(p, bytes);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        /// Underlying memory arena
+        Arena arena_;
+
+        /// Policy resource on top of the arena (empty for monotonic policies)
+        [[no_unique_address]] Storage resource_;
+    };
+
+}
@@ -0,0 +1,435 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+
+namespace my_allocator {
+
+    /**
+     * @brief Caching upstream resource for arena blocks.
+     *
+     * Keeps recently released blocks instead of returning them to
+     * upstream, so short-lived arenas (e.g. one per request) recycle
+     * warm memory without malloc round trips. Arenas opt in by using
+     * the cache as their upstream resource (see policy::Cached).
+     *
+     * Released blocks are bucketed by their exact size and alignment:
+     * arenas allocate a few distinct block sizes over and over, so
+     * exact buckets are hit without rounding waste. At most `buckets`
+     * distinct sizes are cached and the cached footprint never exceeds
+     * max_bytes; everything else goes straight back to upstream.
+     *
+     * With per-thread sub-caches enabled, each thread keeps a few
+     * blocks locally and touches the shared, mutex-protected buckets
+     * only when its slots are empty or full. Thread-local blocks count
+     * against max_bytes as well and are handed back to the shared
+     * buckets when the thread exits. Every sub-cache is registered
+     * process-wide, so destroying a cache returns the blocks parked in
+     * the slots of all live threads to upstream.
+     *
+     * @note Thread-safe; the cache must not be used while it is being
+     *       destroyed.
+     */
+    class BlockCache : public std::pmr::memory_resource
+    {
+        /// Cached block, linked through its own storage
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        /// Shared bucket of equally sized blocks
+        struct Bucket
+        {
+            std::size_t size  = 0;
+            std::size_t align = 0;
+            FreeBlock*  head  = nullptr;
+        };
+
+        /// Block kept by a thread-local sub-cache
+        struct ThreadSlot
+        {
+            BlockCache* owner = nullptr;
+            void*       ptr   = nullptr;
+            std::size_t size  = 0;
+            std::size_t align = 0;
+        };
+
+    public:
+        /// Maximum number of distinct block sizes cached at once
+        static constexpr std::size_t buckets = 16;
+
+        /// Blocks kept per thread when per-thread sub-caches are enabled
+        static constexpr std::size_t thread_slots = 4;
+
+        /**
+         * @brief Creates a cache.
+         *
+         * @param max_bytes  Upper bound of the cached footprint in bytes
+         *                   (shared buckets and thread slots).
+         * @param per_thread Enables per-thread sub-caches.
+         * @param upstream   Source of blocks on cache misses; must
+         *                   outlive the cache.
+         */
+        explicit BlockCache(std::size_t max_bytes = std::size_t{16} << 20,
+                            bool per_thread = false,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+                : upstream_(upstream),
+                  max_bytes_(max_bytes),
+                  per_thread_(per_thread)
+        {}
+
+        BlockCache(const BlockCache&) = delete;
+        BlockCache& operator=(const BlockCache&) = delete;
+
+        /**
+         * @brief Returns all cached blocks to upstream.
+         */
+        ~BlockCache() override
+        {
+            if (per_thread_)
+            {
+                ThreadRegistry& registry = thread_registry();
+                std::lock_guard registry_lock(registry.mutex);
+
+                for (ThreadCache* tc = registry.head; tc; tc = tc->next)
+                {
+                    std::lock_guard lock(tc->mutex);
+
+                    for (ThreadSlot& slot : tc->slots)
+                    {
+                        if (slot.owner == this)
+                        {
+                            unreserve(slot.size);
+                            upstream_->deallocate(slot.ptr, slot.size, slot.align);
+                            slot = ThreadSlot{};
+                        }
+                    }
+                }
+            }
+
+            release();
+        }
+
+        /**
+         * @brief Process-wide cache with per-thread sub-caches.
+         *
+         * Footprint is bounded by 64 MiB.
+         */
+        static BlockCache& global()
+        {
+            static BlockCache cache(std::size_t{64} << 20, true);
+            return cache;
+        }
+
+        /**
+         * @brief Returns every block in the shared buckets to upstream.
+         */
+        void release() noexcept
+        {
+            std::lock_guard lock(mutex_);
+
+            for (Bucket& b : buckets_)
+            {
+                while (b.head)
+                {
+                    FreeBlock* next = b.head->next;
+                    upstream_->deallocate(b.head, b.size, b.align);
+                    b.head = next;
+                }
+
+                b = Bucket{};
+            }
+
+            unreserve(cached_bytes_);
+            cached_bytes_ = 0;
+        }
+
+        /// Bytes currently held in the shared buckets
+        [[nodiscard]] std::size_t cached_bytes() const
+        {
+            std::lock_guard lock(mutex_);
+            return cached_bytes_;
+        }
+
+        /// Number of allocations served from the cache
+        [[nodiscard]] std::size_t hits() const noexcept
+        {
+            return hits_.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (per_thread_ && !thread_cache_gone())
+            {
+                ThreadCache& tc = thread_cache();
+                std::lock_guard lock(tc.mutex);
+
+                for (ThreadSlot& slot : tc.slots)
+                {
+                    if (slot.owner == this && slot.size == bytes && slot.align == alignment)
+                    {
+                        void* ptr = slot.ptr;
+                        unreserve(bytes);
+                        slot = ThreadSlot{};
+                        hits_.fetch_add(1, std::memory_order_relaxed);
+                        return ptr;
+                    }
+                }
+            }
+
+            {
+                std::lock_guard lock(mutex_);
+
+                if (Bucket* b = find(bytes, alignment); b && b->head)
+                {
+                    FreeBlock* block = b->head;
+                    b->head = block->next;
+                    cached_bytes_ -= bytes;
+                    unreserve(bytes);
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    return block;
+                }
+            }
+
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            if (per_thread_ && !thread_cache_gone())
+            {
+                ThreadCache& tc = thread_cache();
+                std::lock_guard lock(tc.mutex);
+
+                for (ThreadSlot& slot : tc.slots)
+                {
+                    if (!slot.owner)
+                    {
+                        if (!reserve(bytes))
+                            break;
+
+                        slot = ThreadSlot{this, p, bytes, alignment};
+                        return;
+                    }
+                }
+            }
+
+            put(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        struct ThreadCache;
+
+        /**
+         * @brief Process-wide list of live per-thread sub-caches
+         *
+         * Lets a cache drain the slots of every thread when it is
+         * destroyed. Lock order: registry, sub-cache, cache.
+         */
+        struct ThreadRegistry
+        {
+            std::mutex   mutex;
+            ThreadCache* head = nullptr;
+        };
+
+        /**
+         * @brief Per-thread sub-cache; flushes its blocks on thread exit
+         *
+         * The mutex is taken by the owning thread on every slot access
+         * (uncontended) and by a cache draining the slots on destruction.
+         */
+        struct ThreadCache
+        {
+            std::mutex mutex;
+            std::array<ThreadSlot, thread_slots> slots{};
+
+            ThreadCache* prev = nullptr;
+            ThreadCache* next = nullptr;
+
+            ThreadCache()
+            {
+                ThreadRegistry& registry = thread_registry();
+                std::lock_guard lock(registry.mutex);
+
+                next = registry.head;
+                if (next)
+                    next->prev = this;
+                registry.head = this;
+            }
+
+            ThreadCache(const ThreadCache&) = delete;
+            ThreadCache& operator=(const ThreadCache&) = delete;
+
+            ~ThreadCache()
+            {
+                ThreadRegistry& registry = thread_registry();
+                std::lock_guard registry_lock(registry.mutex);
+
+                (prev ? prev->next : registry.head) = next;
+                if (next)
+                    next->prev = prev;
+
+                // No cache can be destroyed meanwhile: the registry is locked
+                for (ThreadSlot& slot : slots)
+                {
+                    if (slot.owner)
+                    {
+                        slot.owner->unreserve(slot.size);
+                        slot.owner->put(slot.ptr, slot.size, slot.align);
+                    }
+
+                    slot = ThreadSlot{};
+                }
+
+                thread_cache_gone() = true;
+            }
+        };
+
+        /**
+         * @brief The sub-cache registry
+         *
+         * Never destroyed, so it stays usable while static caches and
+         * thread_locals are destroyed in any order.
+         */
+        static ThreadRegistry& thread_registry() noexcept
+        {
+            static ThreadRegistry* registry = new ThreadRegistry;
+            return *registry;
+        }
+
+        /**
+         * @brief Set once the calling thread's sub-cache is destroyed
+         *
+         * Trivially destructible, so it stays readable while a static
+         * cache is destroyed after the main thread's thread_locals.
+         */
+        static bool& thread_cache_gone() noexcept
+        {
+            thread_local bool gone = false;
+            return gone;
+        }
+
+        static ThreadCache& thread_cache() noexcept
+        {
+            thread_local ThreadCache cache;
+            return cache;
+        }
+
+        /**
+         * @brief Accounts bytes about to be cached
+         *
+         * @return false if the cached footprint would exceed max_bytes
+         */
+        bool reserve(std::size_t bytes) noexcept
+        {
+            std::size_t held = held_bytes_.load(std::memory_order_relaxed);
+
+            do
+            {
+                if (bytes > max_bytes_ - held)
+                    return false;
+            }
+            while (!held_bytes_.compare_exchange_weak(held, held + bytes,
+                                                     std::memory_order_relaxed));
+
+            return true;
+        }
+
+        /// Gives back bytes accounted by reserve()
+        void unreserve(std::size_t bytes) noexcept
+        {
+            held_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Puts a block into the shared buckets or releases it
+         *
+         * Blocks that would exceed max_bytes, that are too small to hold
+         * the free-list link or whose size has no bucket go upstream.
+         */
+        void put(void* p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            {
+                std::lock_guard lock(mutex_);
+
+                if (bytes >= sizeof(FreeBlock) && alignment >= alignof(FreeBlock))
+                {
+                    Bucket* b = find(bytes, alignment);
+
+                    if (!b)
+                        b = claim(bytes, alignment);
+
+                    if (b && reserve(bytes))
+                    {
+                        b->head = ::new (p) FreeBlock{b->head};
+                        cached_bytes_ += bytes;
+                        return;
+                    }
+                }
+            }
+
+            upstream_->deallocate(p, bytes, alignment);
+        }
+
+        /// Finds the bucket of a block size (mutex must be held)
+        Bucket* find(std::size_t bytes, std::size_t alignment) noexcept
+        {
+            for (Bucket& b : buckets_)
+            {
+                if (b.size == bytes && b.align == alignment)
+                    return &b;
+            }
+
+            return nullptr;
+        }
+
+        /// Assigns an empty bucket to a block size (mutex must be held)
+        Bucket* claim(std::size_t bytes, std::size_t alignment) noexcept
+        {
+            for (Bucket& b : buckets_)
+            {
+                if (!b.head)
+                {
+                    b.size = bytes;
+                    b.align = alignment;
+                    return &b;
+                }
+            }
+
+            return nullptr;
+        }
+
+        /// Source of blocks on cache misses
+        std::pmr::memory_resource* upstream_;
+
+        /// Upper bound of held_bytes_
+        std::size_t max_bytes_;
+
+        /// Whether per-thread sub-caches are used
+        bool per_thread_;
+
+        mutable std::mutex mutex_;
+
+        std::array<Bucket, buckets> buckets_{};
+
+        /// Bytes in the shared buckets (mutex must be held)
+        std::size_t cached_bytes_ = 0;
+
+        /// Bytes in the shared buckets and every thread slot
+        std::atomic<std::size_t> held_bytes_{0};
+
+        std::atomic<std::size_t> hits_{0};
+    };
+
+}
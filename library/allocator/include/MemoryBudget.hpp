@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace my_allocator {
+
+    /**
+     * @brief Hierarchical byte budget.
+     *
+     * Budgets form a tree (e.g. process → tenant → request). Charging
+     * a budget charges all of its ancestors as well:
+     *
+     * - hard limit – a charge that would exceed the hard limit of any
+     *                level is rejected with std::bad_alloc and leaves
+     *                every level unchanged (0 means unlimited)
+     * - soft limit – when usage of a level crosses its soft limit
+     *                upwards, its soft-limit callback is invoked; the
+     *                charge itself succeeds (0 disables)
+     *
+     * Usage is accounted in bytes, so allocators of different value
+     * types (e.g. rebound container nodes) are charged by their real
+     * size.
+     *
+     * @note charge(), try_charge() and release() are thread-safe, so
+     *       upper levels may be shared by concurrently running
+     *       requests. Limits and callbacks must be configured before
+     *       the budget is shared.
+     */
+    class MemoryBudget
+    {
+    public:
+
+        /// Invoked with the budget whose soft limit was crossed
+        using SoftLimitCallback = std::function<void(const MemoryBudget&)>;
+
+        /**
+         * @brief Creates a budget.
+         *
+         * @param hard_limit Maximum number of bytes (0 means unlimited).
+         * @param parent     Enclosing budget, or nullptr for a root.
+         */
+        explicit MemoryBudget(std::size_t hard_limit = 0,
+                              std::shared_ptr<MemoryBudget> parent = nullptr)
+                : parent_(std::move(parent)),
+                  hard_limit_(hard_limit)
+        {}
+
+        MemoryBudget(const MemoryBudget&) = delete;
+        MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+        /**
+         * @brief Sets the soft limit and its callback.
+         *
+         * @param soft_limit Usage in bytes above which callback fires.
+         * @param callback   Function invoked on crossing the limit
+         *                   (must not throw).
+         */
+        void set_soft_limit(std::size_t soft_limit, SoftLimitCallback callback)
+        {
+            soft_limit_ = soft_limit;
+            on_soft_limit_ = std::move(callback);
+        }
+
+        /**
+         * @brief Charges bytes to this budget and all ancestors.
+         *
+         * @throws std::bad_alloc if any hard limit would be exceeded
+         */
+        void charge(std::size_t bytes)
+        {
+            if (!try_charge(bytes))
+                throw std::bad_alloc{};
+        }
+
+        /**
+         * @brief Charges bytes to this budget and all ancestors.
+         *
+         * Each level is charged with a compare-and-swap against its hard
+         * limit; if a level rejects the charge, the levels below it are
+         * rolled back. Soft-limit callbacks fire only once the whole
+         * charge has succeeded.
+         *
+         * @return false (leaving every level unchanged) if any hard
+         *         limit would be exceeded
+         */
+        [[nodiscard]] bool try_charge(std::size_t bytes) noexcept
+        {
+            std::size_t before = used_.load(std::memory_order_relaxed);
+
+            do
+            {
+                if (hard_limit_ != 0 && (before > hard_limit_ || bytes > hard_limit_ - before))
+                    return false;
+            }
+            while (!used_.compare_exchange_weak(before, before + bytes,
+                                                std::memory_order_relaxed));
+
+            if (parent_ && !parent_->try_charge(bytes))
+            {
+                used_.fetch_sub(bytes, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (soft_limit_ != 0 && before <= soft_limit_ &&
+                before + bytes > soft_limit_ && on_soft_limit_)
+                on_soft_limit_(*this);
+
+            return true;
+        }
+
+        /**
+         * @brief Returns previously charged bytes.
+         *
+         * Never lowers usage of a level below zero.
+         */
+        void release(std::size_t bytes) noexcept
+        {
+            for (MemoryBudget* b = this; b; b = b->parent_.get())
+            {
+                std::size_t used = b->used_.load(std::memory_order_relaxed);
+
+                while (!b->used_.compare_exchange_weak(used, used - (std::min)(used, bytes),
+                                                       std::memory_order_relaxed))
+                {}
+            }
+        }
+
+        /// Bytes currently charged to this budget (including children)
+        [[nodiscard]] std::size_t used() const noexcept
+        {
+            return used_.load(std::memory_order_relaxed);
+        }
+
+        /// Hard limit in bytes (0 means unlimited)
+        [[nodiscard]] std::size_t hard_limit() const noexcept
+        {
+            return hard_limit_;
+        }
+
+        /// Soft limit in bytes (0 means disabled)
+        [[nodiscard]] std::size_t soft_limit() const noexcept
+        {
+            return soft_limit_;
+        }
+
+        /// Enclosing budget, or nullptr for a root
+        [[nodiscard]] const std::shared_ptr<MemoryBudget>& parent() const noexcept
+        {
+            return parent_;
+        }
+
+    private:
+
+        std::shared_ptr<MemoryBudget> parent_;
+
+        std::size_t hard_limit_;
+        std::size_t soft_limit_ = 0;
+
+        std::atomic<std::size_t> used_{0};
+
+        SoftLimitCallback on_soft_limit_;
+    };
+
+}
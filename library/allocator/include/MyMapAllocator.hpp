@@ -1,11 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
 #include <cstddef>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <new>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 
+#include "BlockCache.hpp"
+#include "MemoryBudget.hpp"
 #include "detail/Arena.hpp"
+#include "detail/BuddyResource.hpp"
+#include "detail/MmapResource.hpp"
+#include "detail/PerCpuResource.hpp"
+#include "detail/RemoteFreeResource.hpp"
+#include "detail/SlabResource.hpp"
+#include "detail/SlotPool.hpp"
+#include "detail/TlsfResource.hpp"
 
 namespace my_allocator {
 
@@ -20,6 +38,16 @@ namespace my_allocator {
          * - max_elements_ – maximum number of elements allowed
          *                   (0 means unlimited)
          * - allocated_    – number of elements logically allocated
+         * - budget_       – optional byte budget charged for every
+         *                   allocation (null means none)
+         * - in_use_       – set by the first allocation; the budget is
+         *                   fixed from then on
+         * - overflow_     – upstream taking allocations that do not fit
+         *                   into the embedded storage (Hybrid policy)
+         * - overflows_    – number of allocations served by overflow_
+         * - last_use_     – time of the last allocation (IdleTrim policy;
+         *                   atomic, since PerCpu allocators are shared
+         *                   between threads)
          *
          * Copies of the allocator share this state via std::shared_ptr,
          * meaning allocation limits are shared across containers
@@ -30,11 +58,222 @@ namespace my_allocator {
             std::size_t max_elements_ = 0;
             std::size_t allocated_    = 0;
 
+            std::shared_ptr<MemoryBudget> budget_;
+            std::atomic<bool>             in_use_{false};
+
+            std::pmr::memory_resource* overflow_  = nullptr;
+            std::size_t                overflows_ = 0;
+
+            std::atomic<std::chrono::steady_clock::time_point> last_use_{};
+
             AllocatorState() = default;
 
             explicit AllocatorState(std::size_t max_elements)
                     : max_elements_(max_elements) {}
         };
+
+        /**
+         * @brief Memory resource selected by a policy.
+         *
+         * Policies that reuse freed memory declare a nested `resource`
+         * type. It is constructed from the shared Arena and provides:
+         *
+         * - void* allocate(std::size_t size, std::size_t alignment)
+         * - void deallocate(void* p, std::size_t size, std::size_t alignment) noexcept
+         *
+         * Monotonic policies declare no resource (type is void) and
+         * allocate directly from the Arena.
+         */
+        template<typename Policy>
+        struct policy_resource {
+            using type = void;
+        };
+
+        template<typename Policy>
+            requires requires { typename Policy::resource; }
+        struct policy_resource<Policy> {
+            using type = typename Policy::resource;
+        };
+
+        template<typename Policy>
+        using policy_resource_t = typename policy_resource<Policy>::type;
+
+        /**
+         * @brief Control block with embedded arena storage.
+         *
+         * Holds the allocation state, the arena and its first block in
+         * a single allocation. Allocator copies share it through
+         * aliasing std::shared_ptr instances.
+         *
+         * @tparam Bytes Size of the embedded first block
+         */
+        template<std::size_t Bytes>
+        struct EmbeddedControl {
+
+            AllocatorState state;
+            Arena          arena;
+
+            alignas(std::max_align_t) std::byte storage[Bytes];
+
+            EmbeddedControl(std::size_t max_elements,
+                            std::size_t block_size,
+                            std::size_t large_threshold,
+                            std::pmr::memory_resource* upstream)
+                    : state(max_elements),
+                      arena(std::span<std::byte>(storage), block_size, large_threshold, upstream)
+            {}
+        };
+
+        /**
+         * @brief Front of a caller-provided buffer being carved.
+         *
+         * cur advances past every allocation made by a CarveAllocator.
+         */
+        struct BufferCarve {
+            std::byte* cur;
+            std::byte* end;
+        };
+
+        /**
+         * @brief Allocator handing out the front of a caller buffer.
+         *
+         * Used with std::allocate_shared to place a control block
+         * (including the std::shared_ptr counters) at the start of a
+         * caller-provided buffer. The carve is only accessed while
+         * allocating; deallocation is a no-op, as the buffer is owned
+         * by the caller.
+         */
+        template<typename T>
+        struct CarveAllocator {
+            using value_type = T;
+
+            BufferCarve* carve;
+
+            explicit CarveAllocator(BufferCarve* carve) noexcept
+                    : carve(carve) {}
+
+            template<typename U>
+            CarveAllocator(const CarveAllocator<U>& other) noexcept
+                    : carve(other.carve) {}
+
+            /// @throws std::bad_alloc if the buffer cannot hold n objects
+            T* allocate(std::size_t n)
+            {
+                const auto cur = reinterpret_cast<std::uintptr_t>(carve->cur);
+                const auto end = reinterpret_cast<std::uintptr_t>(carve->end);
+                const auto aligned = (cur + alignof(T) - 1) & ~(alignof(T) - 1);
+
+                if (aligned > end || n > (end - aligned) / sizeof(T))
+                    throw std::bad_alloc{};
+
+                carve->cur = reinterpret_cast<std::byte*>(aligned + n * sizeof(T));
+                return reinterpret_cast<T*>(aligned);
+            }
+
+            void deallocate(T*, std::size_t) noexcept {}
+
+            template<typename U>
+            bool operator==(const CarveAllocator<U>&) const noexcept
+            {
+                return true;
+            }
+        };
+
+        /**
+         * @brief Control block placed at the start of a caller buffer.
+         *
+         * Holds the allocation state, the arena (over the rest of the
+         * buffer) and the policy resource, so an allocator over a
+         * buffer performs no heap allocation of its own.
+         *
+         * @tparam Resource Policy resource (void for monotonic policies)
+         */
+        template<typename Resource>
+        struct SpanControl {
+
+            /// Placeholder for monotonic policies
+            struct NoResource {
+                explicit NoResource(Arena&) noexcept {}
+            };
+
+            AllocatorState state;
+            Arena          arena;
+
+            [[no_unique_address]]
+            std::conditional_t<std::is_void_v<Resource>, NoResource, Resource> resource;
+
+            /**
+             * @param carve Buffer whose remaining part (after this
+             *              control block) becomes the first arena block
+             */
+            SpanControl(std::size_t max_elements,
+                        const BufferCarve& carve,
+                        std::size_t block_size,
+                        std::pmr::memory_resource* upstream)
+                    : state(max_elements),
+                      arena(std::span<std::byte>(carve.cur, carve.end),
+                            block_size ? block_size : static_cast<std::size_t>(carve.end - carve.cur),
+                            0, upstream),
+                      resource(arena)
+            {}
+        };
+
+        /// Process-wide block cache as an upstream source
+        inline std::pmr::memory_resource* global_block_cache() noexcept
+        {
+            return &BlockCache::global();
+        }
+
+        /// Anonymous page mappings as an upstream source
+        inline std::pmr::memory_resource* mmap_upstream() noexcept
+        {
+            return MmapResource::instance();
+        }
+
+        /**
+         * @brief Upstream memory source selected by a policy.
+         *
+         * Policies may declare
+         *
+         * - static std::pmr::memory_resource* upstream() noexcept
+         *
+         * to choose where the arena obtains its blocks. Otherwise
+         * std::pmr::new_delete_resource() is used.
+         */
+        template<typename Policy>
+        std::pmr::memory_resource* policy_upstream() noexcept
+        {
+            if constexpr (requires { { Policy::upstream() } -> std::convertible_to<std::pmr::memory_resource*>; })
+                return Policy::upstream();
+            else
+                return std::pmr::new_delete_resource();
+        }
+
+        /**
+         * @brief Applies arena options declared by a policy.
+         *
+         * Policies may declare
+         *
+         * - static constexpr double provision_fill
+         *
+         *   to have upcoming blocks prepared in the background once that
+         *   fraction of the current block is used
+         *   (see Arena::enable_provisioning())
+         *
+         * - static constexpr bool color_blocks
+         *
+         *   to stagger block starts by cache-line colors
+         *   (see Arena::enable_coloring())
+         */
+        template<typename Policy>
+        void configure_arena(Arena& arena)
+        {
+            if constexpr (requires { requires Policy::color_blocks; })
+                arena.enable_coloring();
+
+            if constexpr (requires { { Policy::provision_fill } -> std::convertible_to<double>; })
+                arena.enable_provisioning(Policy::provision_fill);
+        }
     }
 
 
@@ -43,16 +282,48 @@ namespace my_allocator {
         /**
          * @brief Fixed-capacity policy.
          *
-         * @tparam Max     Maximum number of elements allowed.
-         * @tparam Initial Initial arena capacity in elements.
+         * @tparam Max          Maximum number of elements allowed.
+         * @tparam Initial      Initial arena capacity in elements.
+         * @tparam NodeOverhead Bytes a container adds to every element
+         *                      (default fits std::map/std::set nodes).
          *
          * Max and Initial are compile-time constants.
          * Typically Initial == Max.
+         *
+         * Storage for Initial elements of the rebound node type
+         * (sizeof(T) + NodeOverhead bytes each) is embedded in the
+         * allocator control block, so creating a container costs one
+         * allocation and its nodes sit next to the arena metadata.
          */
-        template<std::size_t Max, std::size_t Initial = Max>
+        template<std::size_t Max,
+                 std::size_t Initial = Max,
+                 std::size_t NodeOverhead = 4 * sizeof(void*)>
         struct Fixed {
-            static constexpr std::size_t max     = Max;
-            static constexpr std::size_t initial = Initial;
+            static constexpr std::size_t max           = Max;
+            static constexpr std::size_t initial       = Initial;
+            static constexpr std::size_t node_overhead = NodeOverhead;
+        };
+
+        /**
+         * @brief Hybrid fixed-capacity policy.
+         *
+         * @tparam Capacity     Elements served from embedded storage.
+         * @tparam NodeOverhead Bytes a container adds to every element
+         *                      (default fits std::map/std::set nodes).
+         *
+         * Like Fixed, storage for Capacity rebound nodes is embedded in
+         * the allocator control block. Once it is exhausted, allocations
+         * overflow to the upstream memory resource instead of throwing;
+         * deallocation routes every pointer back to its source by an
+         * address-range check. The number of overflowing allocations is
+         * reported by MyMapAllocator::overflows().
+         */
+        template<std::size_t Capacity, std::size_t NodeOverhead = 4 * sizeof(void*)>
+        struct Hybrid {
+            static constexpr std::size_t max           = 0;
+            static constexpr std::size_t initial       = Capacity;
+            static constexpr std::size_t node_overhead = NodeOverhead;
+            static constexpr bool        overflow      = true;
         };
 
         /**
@@ -69,8 +340,304 @@ namespace my_allocator {
             static constexpr std::size_t initial = Initial;
         };
 
+        /**
+         * @brief Runtime-configured policy.
+         *
+         * Limits and arena geometry are passed to the allocator
+         * constructor as a Config instead of template arguments, so
+         * capacity can be tuned per deployment without a rebuild and
+         * without instantiating a new allocator type per combination.
+         *
+         * Allocation is monotonic, as with Fixed and Expandable.
+         */
+        struct Runtime {
+            static constexpr std::size_t max     = 0;
+            static constexpr std::size_t initial = 0;
+
+            /**
+             * @brief Runtime allocator configuration.
+             *
+             * - max           – maximum number of elements allowed
+             *                   (0 means unlimited)
+             * - block_size    – size of the first arena block in bytes
+             * - growth_factor – block size multiplier applied each time
+             *                   the arena grows (1 keeps blocks equal)
+             */
+            struct Config {
+                std::size_t max           = 0;
+                std::size_t block_size    = 4096;
+                double      growth_factor = 1.0;
+            };
+        };
+
+        /**
+         * @brief Bounded node pool policy.
+         *
+         * @tparam Slots Number of slots in the pool.
+         *
+         * Slots are sized for the first allocated type (the rebound
+         * node type of a container) and reserved in one piece on first
+         * use. Deallocated slots are reused, so a container may insert
+         * and erase indefinitely as long as at most Slots nodes are
+         * alive at once.
+         */
+        template<std::size_t Slots>
+        struct Pool {
+            static constexpr std::size_t max     = 0;
+            static constexpr std::size_t initial = 0;
+
+            using resource = detail::SlotPool<Slots>;
+        };
+
+        /**
+         * @brief Buddy-system policy for mixed-size allocations.
+         *
+         * @tparam HeapSize Bytes per buddy heap (power of two).
+         * @tparam MinBlock Smallest block in bytes (power of two).
+         *
+         * Heaps are carved from the arena on demand and split into
+         * power-of-two blocks. Freed blocks coalesce with their buddies
+         * and are reused. Requests above HeapSize are served by the
+         * arena directly.
+         */
+        template<std::size_t HeapSize = 65536, std::size_t MinBlock = 32>
+        struct Buddy {
+            static constexpr std::size_t max     = 0;
+            static constexpr std::size_t initial = 0;
+
+            using resource = detail::BuddyResource<HeapSize, MinBlock>;
+        };
+
+        /**
+         * @brief Two-level segregated fit (TLSF) policy.
+         *
+         * @tparam PoolSize Bytes per TLSF pool (power of two).
+         *
+         * General-purpose allocation and deallocation with O(1) bounds:
+         * free blocks are found through a two-level bitmap index and
+         * coalesced with their neighbours immediately on deallocation.
+         * Requests above PoolSize / 4 are served by the arena directly.
+         */
+        template<std::size_t PoolSize = 65536>
+        struct Tlsf {
+            static constexpr std::size_t max     = 0;
+            static constexpr std::size_t initial = 0;
+
+            using resource = detail::TlsfResource<PoolSize>;
+        };
+
+        /**
+         * @brief Per-CPU arena policy.
+         *
+         * @tparam ChunkSize Bytes per CPU-local chunk.
+         *
+         * Each CPU bumps inside its own chunk with a lock-free
+         * compare-and-swap, chosen by sched_getcpu(). Memory overhead
+         * scales with cores rather than threads, and allocations from
+         * threads on different CPUs do not contend. Allocators of this
+         * policy may be shared between threads.
+         * Allocation is monotonic.
+         */
+        template<std::size_t ChunkSize = 65536>
+        struct PerCpu {
+            static constexpr std::size_t max     = 0;
+            static constexpr std::size_t initial = 0;
+
+            using resource = detail::PerCpuResource<ChunkSize>;
+        };
+
+        /**
+         * @brief Bitmap slab policy.
+         *
+         * @tparam SlotsPerSlab Slots per slab (multiple of 64).
+         *
+         * Slabs of equally sized slots (sized for the first allocated
+         * type) are carved from the arena on demand. Occupancy is kept
+         * in per-slab bitmaps; freed slots are reused lowest address
+         * first.
+         */
+        template<std::size_t SlotsPerSlab = 512>
+        struct Slab {
+            static constexpr std::size_t max     = 0;
+            static constexpr std::size_t initial = 0;
+
+            using resource = detail::SlabResource<SlotsPerSlab>;
+        };
+
+        /**
+         * @brief Policy adaptor selecting the arena's upstream source.
+         *
+         * @tparam Base   Underlying policy.
+         * @tparam Source Function returning the upstream
+         *                std::pmr::memory_resource (must outlive
+         *                every allocator using it).
+         *
+         * Keeps all properties of Base; only the memory source
+         * of arena blocks changes.
+         */
+        template<typename Base, std::pmr::memory_resource* (*Source)() noexcept>
+        struct WithUpstream : Base {
+            static std::pmr::memory_resource* upstream() noexcept
+            {
+                return Source();
+            }
+        };
+
+        /**
+         * @brief Policy adaptor recycling arena blocks through
+         *        the process-wide BlockCache.
+         *
+         * @tparam Base Underlying policy.
+         */
+        template<typename Base>
+        using Cached = WithUpstream<Base, &detail::global_block_cache>;
+
+        /**
+         * @brief Policy adaptor taking arena blocks from anonymous
+         *        page mappings.
+         *
+         * Lets trim() hand unused pages back to the OS.
+         *
+         * @tparam Base Underlying policy.
+         */
+        template<typename Base>
+        using Mmap = WithUpstream<Base, &detail::mmap_upstream>;
+
+        /**
+         * @brief Policy adaptor enabling idle trimming.
+         *
+         * @tparam Base   Underlying policy.
+         * @tparam IdleMs Milliseconds without allocations after which
+         *                MyMapAllocator::trim_if_idle() trims the arena.
+         *
+         * Allocations record their time, so the application's idle hook
+         * or timer (running on the thread owning the allocator) can
+         * release memory after quiet periods.
+         */
+        template<typename Base, std::size_t IdleMs>
+        struct IdleTrim : Base {
+            static constexpr std::chrono::milliseconds idle_trim{IdleMs};
+        };
+
+
+        /**
+         * @brief Policy adaptor accepting deallocations from other threads.
+         *
+         * @tparam Base Underlying policy with a reusing resource
+         *              (e.g. Pool, Slab, Tlsf).
+         *
+         * The thread constructing the allocator owns it and is the only
+         * one allowed to allocate. Any thread may deallocate: foreign
+         * frees are pushed lock-free onto a remote-free queue and handed
+         * back to Base's free lists by the owner's next allocation, so a
+         * consumer thread may destroy nodes a producer created.
+         */
+        template<typename Base>
+            requires requires { typename Base::resource; }
+        struct RemoteFree : Base {
+            using resource = detail::RemoteFreeResource<typename Base::resource>;
+        };
+
+        /**
+         * @brief Policy adaptor preparing arena blocks in the background.
+         *
+         * @tparam Base        Underlying policy.
+         * @tparam FillPercent Used percentage of the current block at
+         *                     which the next block is prepared.
+         *
+         * A worker thread allocates and pre-faults the next block, so
+         * arena growth on the allocating thread only swaps it in. The
+         * upstream source must be thread-safe.
+         */
+        template<typename Base, std::size_t FillPercent = 50>
+            requires (FillPercent > 0 && FillPercent <= 100)
+        struct Provisioned : Base {
+            static constexpr double provision_fill = FillPercent / 100.0;
+        };
+
+        /**
+         * @brief Policy adaptor enabling cache-line coloring of blocks.
+         *
+         * @tparam Base Underlying policy.
+         *
+         * Each arena block starts at a rotating multiple of the
+         * cache-line size, so the first nodes of many small containers
+         * (map roots, list heads) spread over different cache sets.
+         * Costs at most an eighth of every block.
+         */
+        template<typename Base>
+        struct Colored : Base {
+            static constexpr bool color_blocks = true;
+        };
+
+        /**
+         * @brief Policy adaptor isolating allocations on cache lines.
+         *
+         * @tparam Base Underlying policy.
+         *
+         * Every allocation is aligned to and rounded up to whole cache
+         * lines, so nodes written concurrently by different threads
+         * (e.g. per-key counters) never share a line. Trades memory for
+         * the absence of false sharing; byte budgets are charged the
+         * rounded size.
+         */
+        template<typename Base>
+        struct LineIsolated : Base {
+            static constexpr bool isolate_lines = true;
+        };
+
     }
 
+    /**
+     * @brief Shared, type-erased handle to an arena.
+     *
+     * Allocators of any value type and any policy can be built from
+     * the same handle, so e.g. a map, a list and a string pool serving
+     * one request draw from a single arena: fewer block allocations
+     * and related data kept close together.
+     *
+     * Each allocator built from a handle keeps its own logical
+     * allocation state and policy resource; only the arena is shared.
+     * The arena lives as long as any handle or allocator refers to it.
+     */
+    class ArenaHandle
+    {
+    public:
+
+        /**
+         * @brief Creates a new arena.
+         *
+         * @param block_size Default size of arena blocks in bytes.
+         * @param upstream   Source of arena blocks; must outlive the arena.
+         */
+        explicit ArenaHandle(std::size_t block_size = 4096,
+                             std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+                : arena_(std::make_shared<detail::Arena>(block_size, 0, upstream))
+        {}
+
+        /**
+         * @brief Wraps an existing shared arena.
+         */
+        explicit ArenaHandle(std::shared_ptr<detail::Arena> arena) noexcept
+                : arena_(std::move(arena))
+        {}
+
+        /// Shared underlying arena
+        const std::shared_ptr<detail::Arena>& arena() const noexcept
+        {
+            return arena_;
+        }
+
+        bool operator==(const ArenaHandle& other) const noexcept
+        {
+            return arena_ == other.arena_;
+        }
+
+    private:
+
+        std::shared_ptr<detail::Arena> arena_;
+    };
+
 }
 
 
@@ -89,18 +656,36 @@ namespace my_allocator {
  *    - No logical element limit is enforced.
  *    - Arena may grow when needed.
  *
+ * 3. Runtime mode (policy::Runtime)
+ *    - Limit, block size and growth factor are taken from a
+ *      policy::Runtime::Config passed to the constructor.
+ *
+ * Policies declaring a nested `resource` type (e.g. policy::Pool)
+ * route allocation and deallocation through that resource, which
+ * reuses freed memory on top of the arena.
+ *
  * Initial arena capacity is defined by Policy::initial.
  *
+ * Arena blocks come from the upstream std::pmr::memory_resource chosen
+ * by the policy (see policy::WithUpstream) or passed to the
+ * constructor, which allows nesting arenas. A caller-provided buffer
+ * (stack or static storage) may serve as the first block.
+ *
+ * Allocators of different value types and policies can share one
+ * arena through my_allocator::ArenaHandle.
+ *
  * Copies of the allocator share:
  *  - underlying Arena
  *  - logical allocation state
+ *  - policy resource (if any)
  *
- * Memory is reclaimed only when the last allocator copy is destroyed.
+ * Memory is returned to the system only when the last allocator copy
+ * is destroyed.
  *
  * @tparam T      Value type
  * @tparam Policy Compile-time configuration type
  *
- * @note Not thread-safe.
+ * @note Not thread-safe, except with policy::PerCpu.
  */
 template<
         typename T,
@@ -133,16 +718,66 @@ private:
 
     using Arena          = my_allocator::detail::Arena;
     using AllocatorState = my_allocator::detail::AllocatorState;
+    using Resource       = my_allocator::detail::policy_resource_t<Policy>;
+
+    static constexpr bool HasResource = !std::is_void_v<Resource>;
+    /// Runtime policy, possibly wrapped in policy adaptors
+    static constexpr bool IsRuntime   = std::is_base_of_v<my_allocator::policy::Runtime, Policy>;
 
     static constexpr std::size_t MaxElements = Policy::max;
     static constexpr std::size_t Initial     = Policy::initial;
 
+    /// Fixed and Hybrid policies embed their first block in the control block
+    static constexpr bool HasEmbeddedStorage =
+            Initial > 0 && !HasResource &&
+            requires { Policy::node_overhead; };
+
+    /// Element accounting is only kept when a limit is enforced
+    static constexpr bool HasLimit = IsRuntime || MaxElements != 0;
+
+    /// IdleTrim policies record the time of every allocation
+    static constexpr bool HasIdleTrim = requires { Policy::idle_trim; };
+
+    /// Hybrid policies overflow to upstream instead of growing the arena
+    static constexpr bool IsHybrid =
+            HasEmbeddedStorage && requires { requires Policy::overflow; };
+
+    /// LineIsolated policies give every allocation whole cache lines
+    static constexpr bool IsolatesLines = requires { requires Policy::isolate_lines; };
+
+    /// Alignment of every allocation
+    static constexpr std::size_t Alignment =
+            IsolatesLines ? (std::max)(alignof(T), Arena::cache_line) : alignof(T);
+
+    /// Largest n whose byte size the arena can serve without overflow
+    static constexpr std::size_t MaxCount = Arena::max_request(Alignment) / sizeof(T);
+
+    /**
+     * @brief Bytes requested for n objects (rounded to cache lines if isolated)
+     *
+     * Saturates for n above MaxCount, so the result is rejected by the
+     * arena instead of wrapping around to a small size.
+     */
+    static constexpr std::size_t bytes_for(std::size_t n) noexcept
+    {
+        if (n > MaxCount)
+            return std::numeric_limits<std::size_t>::max();
+
+        if constexpr (IsolatesLines)
+            return (n * sizeof(T) + Arena::cache_line - 1) & ~(Arena::cache_line - 1);
+        else
+            return n * sizeof(T);
+    }
+
     /// Shared allocation accounting
     std::shared_ptr<AllocatorState> state_;
 
     /// Shared underlying memory arena
     std::shared_ptr<Arena> arena_;
 
+    /// Shared policy resource (null for monotonic policies)
+    std::shared_ptr<Resource> resource_;
+
 public:
 
     /**
@@ -153,20 +788,170 @@ public:
      * - If Policy::max > 0 → fixed logical limit
      * - If Policy::max == 0 → unlimited logical capacity
      *
-     * Arena initial size is Policy::initial * sizeof(T).
+     * Arena initial size is Policy::initial * sizeof(T); for Fixed
+     * policies the first block is embedded in the control block and
+     * sized for Policy::initial rebound nodes.
+     * Arena blocks come from the policy's upstream source.
      */
     MyMapAllocator()
+            : MyMapAllocator(my_allocator::detail::policy_upstream<Policy>())
+    {}
+
+    /**
+     * @brief Constructs allocator on top of an explicit memory source.
+     *
+     * @param upstream Source of arena blocks; must outlive every copy
+     *                 of the allocator.
+     */
+    explicit MyMapAllocator(std::pmr::memory_resource* upstream)
+        requires (!IsRuntime)
     {
-        if constexpr (MaxElements > 0) {
-            state_ = std::make_shared<AllocatorState>(MaxElements);
+        constexpr std::size_t arena_bytes =
+                Initial * sizeof(T);
+
+        if constexpr (HasEmbeddedStorage) {
+            constexpr std::size_t node_bytes =
+                    sizeof(T) + Policy::node_overhead;
+
+            // Isolated nodes take whole lines, plus padding for the first one
+            constexpr std::size_t embedded_bytes = IsolatesLines
+                    ? Initial * ((node_bytes + Arena::cache_line - 1) & ~(Arena::cache_line - 1)) +
+                      Arena::cache_line
+                    : Initial * node_bytes;
+
+            using Control = my_allocator::detail::EmbeddedControl<embedded_bytes>;
+
+            std::shared_ptr<Control> control;
+
+            if constexpr (IsHybrid) {
+                // The arena never grows: it is limited to the embedded
+                // storage, everything else overflows to upstream
+                control = std::make_shared<Control>(0, 0, embedded_bytes,
+                                                    std::pmr::null_memory_resource());
+                control->state.overflow_ = upstream;
+            } else {
+                control = std::make_shared<Control>(MaxElements, arena_bytes, 0, upstream);
+            }
+
+            state_ = std::shared_ptr<AllocatorState>(control, &control->state);
+            arena_ = std::shared_ptr<Arena>(control, &control->arena);
         } else {
-            state_ = std::make_shared<AllocatorState>();
+            if constexpr (MaxElements > 0) {
+                state_ = std::make_shared<AllocatorState>(MaxElements);
+            } else {
+                state_ = std::make_shared<AllocatorState>();
+            }
+
+            arena_ = std::make_shared<Arena>(arena_bytes, 0, upstream);
         }
 
-        constexpr std::size_t arena_bytes =
+        if constexpr (!IsHybrid)
+            my_allocator::detail::configure_arena<Policy>(*arena_);
+
+        if constexpr (HasResource)
+            resource_ = std::make_shared<Resource>(*arena_);
+    }
+
+    /**
+     * @brief Constructs allocator on a shared arena.
+     *
+     * The allocator gets its own logical allocation state and policy
+     * resource, but draws memory from the arena referred to by the
+     * handle, which may also back allocators of other types and
+     * policies.
+     *
+     * @param handle Arena to allocate from.
+     */
+    explicit MyMapAllocator(const my_allocator::ArenaHandle& handle)
+        requires (!IsHybrid)
+            : state_(std::make_shared<AllocatorState>(MaxElements)),
+              arena_(handle.arena())
+    {
+        if constexpr (HasResource)
+            resource_ = std::make_shared<Resource>(*arena_);
+    }
+
+    /**
+     * @brief Constructs allocator over a caller-provided buffer.
+     *
+     * The buffer (e.g. stack or static storage) becomes the first arena
+     * block without being owned. The allocator's control block (shared
+     * state, arena and policy resource) is carved from the front of the
+     * buffer, so small workloads perform no heap allocations at all;
+     * buffers too small to hold it (it is dominated by sizeof(Arena))
+     * keep the control block on the heap instead. Once the buffer is
+     * exhausted, blocks of
+     * Policy::initial elements (or of the buffer size, if that is zero)
+     * are taken from upstream. Passing std::pmr::null_memory_resource()
+     * disables the fallback: exhaustion throws std::bad_alloc.
+     *
+     * @param buffer   Initial storage; must outlive every copy of the
+     *                 allocator.
+     * @param upstream Fallback source of arena blocks.
+     */
+    explicit MyMapAllocator(std::span<std::byte> buffer,
+                            std::pmr::memory_resource* upstream =
+                                    my_allocator::detail::policy_upstream<Policy>())
+        requires (!IsRuntime && !IsHybrid)
+    {
+        using Control = my_allocator::detail::SpanControl<Resource>;
+        using Carve   = my_allocator::detail::CarveAllocator<Control>;
+
+        constexpr std::size_t block_bytes =
                 Initial * sizeof(T);
 
-        arena_ = std::make_shared<Arena>(arena_bytes);
+        my_allocator::detail::BufferCarve carve{buffer.data(), buffer.data() + buffer.size()};
+        std::shared_ptr<Control> control;
+
+        try {
+            // The constructor runs after allocation and sees the
+            // carve advanced past the control block
+            control = std::allocate_shared<Control>(Carve(&carve), MaxElements, carve,
+                                                    block_bytes, upstream);
+        } catch (const std::bad_alloc&) {
+            // Buffer too small for the control block: keep it on the heap
+            carve = {buffer.data(), buffer.data() + buffer.size()};
+            control = std::make_shared<Control>(MaxElements, carve, block_bytes, upstream);
+        }
+
+        state_ = std::shared_ptr<AllocatorState>(control, &control->state);
+        arena_ = std::shared_ptr<Arena>(control, &control->arena);
+
+        my_allocator::detail::configure_arena<Policy>(*arena_);
+
+        if constexpr (HasResource)
+            resource_ = std::shared_ptr<Resource>(control, &control->resource);
+    }
+
+    /**
+     * @brief Constructs runtime-policy allocator with default settings.
+     *
+     * Uses a default-constructed policy::Runtime::Config.
+     *
+     * @param upstream Source of arena blocks; must outlive every copy
+     *                 of the allocator.
+     */
+    explicit MyMapAllocator(std::pmr::memory_resource* upstream)
+        requires IsRuntime
+            : MyMapAllocator(my_allocator::policy::Runtime::Config{}, upstream)
+    {}
+
+    /**
+     * @brief Constructs allocator from a runtime configuration.
+     *
+     * @param config   Element limit and arena geometry.
+     * @param upstream Source of arena blocks; must outlive every copy
+     *                 of the allocator.
+     */
+    explicit MyMapAllocator(const my_allocator::policy::Runtime::Config& config,
+                            std::pmr::memory_resource* upstream =
+                                    my_allocator::detail::policy_upstream<Policy>())
+        requires IsRuntime
+            : state_(std::make_shared<AllocatorState>(config.max)),
+              arena_(std::make_shared<Arena>(config.block_size, 0, upstream,
+                                             config.growth_factor))
+    {
+        my_allocator::detail::configure_arena<Policy>(*arena_);
     }
 
     /**
@@ -181,7 +966,8 @@ public:
     template<typename U>
     MyMapAllocator(const MyMapAllocator<U, Policy>& other) noexcept
             : state_(other.state_),
-              arena_(other.arena_)
+              arena_(other.arena_),
+              resource_(other.resource_)
     {}
 
     /**
@@ -192,40 +978,286 @@ public:
      *
      * In expandable mode:
      *   No logical limit check is performed.
+     *
+     * In runtime mode:
+     *   Throws std::bad_alloc if a configured limit is exceeded.
      */
     T* allocate(std::size_t n)
     {
-        if constexpr (MaxElements != 0)
-        {
-            if (state_->allocated_ + n > state_->max_elements_)
-                throw std::bad_alloc{};
+        if (n > MaxCount || !within_limit(n))
+            throw std::bad_alloc{};
+
+        const std::size_t bytes = bytes_for(n);
+
+        my_allocator::MemoryBudget* budget = state_->budget_.get();
+
+        if (budget)
+            budget->charge(bytes);
+
+        void* ptr;
+
+        try {
+            if constexpr (HasResource) {
+                ptr = resource_->allocate(bytes, Alignment);
+            } else if constexpr (IsHybrid) {
+                ptr = arena_->try_allocate_bytes<Alignment>(bytes);
+
+                if (!ptr) [[unlikely]] {
+                    ptr = state_->overflow_->allocate(bytes, Alignment);
+                    ++state_->overflows_;
+                }
+            } else {
+                ptr = arena_->allocate_bytes<Alignment>(bytes);
+            }
+        } catch (...) {
+            if (budget)
+                budget->release(bytes);
+            throw;
         }
 
-        void* ptr = arena_->allocate_bytes(
-                n * sizeof(T),
-                alignof(T)
-        );
+        if constexpr (HasLimit)
+            state_->allocated_ += n;
+
+        if constexpr (HasIdleTrim)
+            state_->last_use_.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
+
+        if (!state_->in_use_.load(std::memory_order_relaxed)) [[unlikely]]
+            state_->in_use_.store(true, std::memory_order_relaxed);
+
+        return static_cast<T*>(ptr);
+    }
+
+    /**
+     * @brief Allocates memory for n objects of type T without throwing.
+     *
+     * Same limits and budgets as allocate(), but every failure
+     * (logical limit, byte budget, exhausted pool, upstream failure)
+     * is reported by returning nullptr. Limit and budget rejections
+     * never raise an exception internally, so load-shedding paths
+     * stay cheap.
+     *
+     * @return Pointer to memory for n objects, or nullptr.
+     */
+    T* try_allocate(std::size_t n) noexcept
+    {
+        if (n > MaxCount || !within_limit(n))
+            return nullptr;
+
+        const std::size_t bytes = bytes_for(n);
+
+        my_allocator::MemoryBudget* budget = state_->budget_.get();
+
+        if (budget && !budget->try_charge(bytes))
+            return nullptr;
+
+        void* ptr = try_allocate_bytes(bytes);
+
+        if (!ptr) {
+            if (budget)
+                budget->release(bytes);
+            return nullptr;
+        }
+
+        if constexpr (HasLimit)
+            state_->allocated_ += n;
+
+        if constexpr (HasIdleTrim)
+            state_->last_use_.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
+
+        if (!state_->in_use_.load(std::memory_order_relaxed)) [[unlikely]]
+            state_->in_use_.store(true, std::memory_order_relaxed);
 
-        state_->allocated_ += n;
         return static_cast<T*>(ptr);
     }
 
     /**
      * @brief Deallocate memory for n objects.
      *
-     * Physical memory is not returned to the arena.
-     * Arena follows monotonic allocation model.
+     * The bytes are returned to the byte budget (if any).
+     * With a policy resource the memory is handed back to it for reuse.
+     * Hybrid policies return overflow allocations to upstream.
+     * Otherwise only large allocations are released individually;
+     * block memory follows the arena's monotonic allocation model.
+     */
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        const std::size_t bytes = bytes_for(n);
+
+        if (state_->budget_)
+            state_->budget_->release(bytes);
+
+        if constexpr (HasResource) {
+            resource_->deallocate(p, bytes, Alignment);
+        } else if constexpr (IsHybrid) {
+            if (!arena_->in_buffer(p))
+                state_->overflow_->deallocate(p, bytes, Alignment);
+        } else {
+            arena_->deallocate_bytes(p, bytes);
+        }
+    }
+
+    /**
+     * @brief Access to the shared policy resource.
+     *
+     * Allows querying resource-specific statistics
+     * (e.g. slab occupancy).
+     */
+    const auto& resource() const noexcept
+        requires HasResource
+    {
+        return *resource_;
+    }
+
+    /**
+     * @brief Attaches a byte budget.
+     *
+     * Every subsequent allocation through this allocator or any of
+     * its copies (including rebound ones) is charged to the budget by
+     * its size in bytes, and every deallocation returns the bytes.
+     * Allocations that would exceed a hard limit anywhere in the
+     * budget hierarchy throw std::bad_alloc.
+     *
+     * The budget must be attached before the first allocation and
+     * stays fixed afterwards, so every deallocation returns its bytes
+     * to the budget that was charged for them.
+     *
+     * @param budget Budget to charge (nullptr detaches).
+     *
+     * @throws std::logic_error if memory has already been allocated
+     *         and budget differs from the current one
+     */
+    void set_budget(std::shared_ptr<my_allocator::MemoryBudget> budget)
+    {
+        if (budget == state_->budget_)
+            return;
+
+        if (state_->in_use_.load(std::memory_order_relaxed))
+            throw std::logic_error("budget cannot change after allocation");
+
+        state_->budget_ = std::move(budget);
+    }
+
+    /// Byte budget charged by this allocator (may be null)
+    const std::shared_ptr<my_allocator::MemoryBudget>& budget() const noexcept
+    {
+        return state_->budget_;
+    }
+
+    /**
+     * @brief Releases unused arena memory.
+     *
+     * The policy resource, if it can, first gives back its wholly free
+     * slabs, heaps or pools (e.g. detail::TlsfResource::trim()); then
+     * the arena is trimmed (see detail::Arena::trim()). Affects every
+     * allocator sharing the resource and the arena.
+     *
+     * Resources that serialize arena access themselves (PerCpu) trim
+     * the arena under their lock, so trim() may run concurrently with
+     * allocations from other threads.
+     *
+     * @return Number of bytes released or handed back to the OS.
      */
-    void deallocate(T*, std::size_t) noexcept {}
+    std::size_t trim() noexcept
+    {
+        if constexpr (requires { requires Resource::trims_arena; })
+            return resource_->trim();
+
+        std::size_t released = 0;
+
+        if constexpr (requires { resource_->trim(); })
+            released += resource_->trim();
+
+        return released + arena_->trim();
+    }
+
+    /**
+     * @brief Trims the arena if it has been idle long enough.
+     *
+     * @return true if no allocation happened for Policy::idle_trim
+     *         and the arena was trimmed.
+     */
+    bool trim_if_idle() noexcept
+        requires HasIdleTrim
+    {
+        if (std::chrono::steady_clock::now() - state_->last_use_.load(std::memory_order_relaxed) <
+            Policy::idle_trim)
+            return false;
+
+        trim();
+        return true;
+    }
+
+    /**
+     * @brief Number of allocations that overflowed to upstream.
+     */
+    std::size_t overflows() const noexcept
+        requires IsHybrid
+    {
+        return state_->overflows_;
+    }
+
+    /**
+     * @brief Handle to the underlying arena.
+     *
+     * Lets allocators of other types or policies share this arena.
+     */
+    my_allocator::ArenaHandle arena_handle() const noexcept
+    {
+        return my_allocator::ArenaHandle(arena_);
+    }
+
+    /**
+     * @brief Takes over all memory of another allocator's arena.
+     *
+     * Blocks are transferred in O(1) (see detail::Arena::adopt()), and
+     * other's arena forwards all further growth here. Afterwards both
+     * allocators compare equal, so nodes built by other can be spliced
+     * into containers using this allocator (e.g. std::map::merge)
+     * without copying, and other's containers may be destroyed first.
+     *
+     * Only for monotonic policies; both arenas must use the same
+     * upstream and large-allocation threshold, other's arena must
+     * not use a caller-provided buffer and both allocators must charge
+     * the same byte budget (or none).
+     *
+     * Both allocators then draw from one arena, which is not
+     * thread-safe: other (and every copy of it) must not allocate or
+     * deallocate concurrently with this allocator, e.g. the worker
+     * thread that used it must be done (see detail::Arena::forward_to()).
+     *
+     * @throws std::invalid_argument if the allocators are incompatible
+     */
+    template<typename U, typename P>
+    void adopt(const MyMapAllocator<U, P>& other)
+        requires (!HasResource && !IsHybrid &&
+                  !MyMapAllocator<U, P>::HasResource && !MyMapAllocator<U, P>::IsHybrid)
+    {
+        if (state_->budget_ != other.state_->budget_)
+            throw std::invalid_argument("allocators charge different budgets");
+
+        std::shared_ptr<Arena> into = root(arena_);
+        std::shared_ptr<Arena> from = root(other.arena_);
+
+        if (into == from)
+            return;
+
+        into->adopt(*from);
+        from->forward_to(std::move(into));
+    }
 
     /**
      * @brief Allocator equality.
      *
-     * Two allocators are equal if they share the same arena.
+     * Two allocators are equal if they share the same arena (directly
+     * or through adopt()), the same policy resource (allocators
+     * built separately from one ArenaHandle reuse memory through
+     * different resources) and the same byte budget, so memory freed
+     * through either is returned where it was charged.
      */
     bool operator==(const MyMapAllocator& other) const noexcept
     {
-        return arena_ == other.arena_;
+        return root(arena_) == root(other.arena_) && resource_ == other.resource_ &&
+               state_->budget_ == other.state_->budget_;
     }
 
     bool operator!=(const MyMapAllocator& other) const noexcept
@@ -235,4 +1267,69 @@ public:
 
     template<typename, typename>
     friend class MyMapAllocator;
+
+private:
+
+    /// Arena that finally owns memory of arena (following adopt())
+    static std::shared_ptr<Arena> root(std::shared_ptr<Arena> arena) noexcept
+    {
+        while (arena->forwarded_to())
+            arena = arena->forwarded_to();
+
+        return arena;
+    }
+
+    /**
+     * @brief Checks the logical element limit.
+     *
+     * @return false if allocating n more elements would exceed
+     *         the limit of a fixed or runtime policy.
+     */
+    bool within_limit(std::size_t n) const noexcept
+    {
+        if constexpr (IsRuntime)
+            return state_->max_elements_ == 0 ||
+                   state_->allocated_ + n <= state_->max_elements_;
+        else if constexpr (MaxElements != 0)
+            return state_->allocated_ + n <= state_->max_elements_;
+        else
+            return true;
+    }
+
+    /**
+     * @brief Obtains raw memory without throwing.
+     *
+     * Uses the non-throwing paths of the arena and of resources that
+     * provide try_allocate(); other failures are caught and reported
+     * as nullptr.
+     */
+    void* try_allocate_bytes(std::size_t bytes) noexcept
+    {
+        if constexpr (HasResource) {
+            if constexpr (requires { resource_->try_allocate(bytes, Alignment); }) {
+                return resource_->try_allocate(bytes, Alignment);
+            } else {
+                try {
+                    return resource_->allocate(bytes, Alignment);
+                } catch (...) {
+                    return nullptr;
+                }
+            }
+        } else {
+            if (void* ptr = arena_->try_allocate_bytes<Alignment>(bytes)) [[likely]]
+                return ptr;
+
+            try {
+                if constexpr (IsHybrid) {
+                    void* ptr = state_->overflow_->allocate(bytes, Alignment);
+                    ++state_->overflows_;
+                    return ptr;
+                } else {
+                    return arena_->allocate_bytes<Alignment>(bytes);
+                }
+            } catch (...) {
+                return nullptr;
+            }
+        }
+    }
 };
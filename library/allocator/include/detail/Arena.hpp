@@ -1,30 +1,71 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
-#include <vector>
+#include <memory_resource>
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <new>
+#include <span>
 #include <stdexcept>
 
+#include "BlockProvisioner.hpp"
+#include "MmapResource.hpp"
+
+// Keeps slow paths out of the inlined fast path and off hot code pages
+// (undefined again at the end of this header)
+#if defined(__GNUC__) || defined(__clang__)
+#define MY_ALLOCATOR_COLD [[gnu::noinline, gnu::cold]]
+#elif defined(_MSC_VER)
+#define MY_ALLOCATOR_COLD __declspec(noinline)
+#else
+#define MY_ALLOCATOR_COLD
+#endif
+
 namespace my_allocator::detail
 {
     /**
      * @brief Monotonic memory arena for raw byte allocation
      *
-     * Arena manages memory in a sequence of dynamically allocated blocks.
+     * Arena manages memory in an intrusive list of dynamically allocated
+     * blocks.
      * Memory is allocated linearly from each block and is never returned
      * back to the arena individually.
      *
      * When the current block cannot satisfy an allocation request,
-     * a new block is allocated and appended to the arena.
+     * its unused tail is indexed and a new block is allocated and
+     * appended to the arena. Later requests that do not fit into the
+     * current block are served from indexed tails first, so space left
+     * behind in older blocks is not lost.
+     *
+     * Requests larger than the large-allocation threshold bypass the
+     * blocks: each one gets a dedicated upstream allocation, tracked in a
+     * separate list and released individually by deallocate_bytes().
+     * The current block thus stays available for small objects.
      *
      * This class:
      * - supports aligned memory allocation
      * - grows dynamically by adding new blocks
-     * - does not support deallocation of individual allocations
+     * - does not support deallocation of individual small allocations
+     *
+     * Blocks and large allocations are obtained from an upstream
+     * std::pmr::memory_resource (std::pmr::new_delete_resource() by
+     * default), so arenas can be stacked on any memory source: mmap,
+     * a user callback or another arena.
+     *
+     * All memory is released when the Arena object is destroyed;
+     * trim() returns unused memory earlier.
+     *
+     * With enable_provisioning(), the next block is prepared by a
+     * background thread while the current one fills up, so growth does
+     * not pay for upstream allocation and page faults.
      *
-     * All memory is released only when the Arena object is destroyed.
+     * With enable_coloring(), each block starts at a rotating multiple
+     * of the cache-line size, so the first (and typically hottest)
+     * objects of many arenas do not all map to the same cache sets.
      *
      * @note This class is not thread-safe
      * @note Intended for use by custom allocators
@@ -32,59 +73,230 @@ namespace my_allocator::detail
     class Arena
     {
         /**
-         * @brief Internal memory block
+         * @brief Header of an internal memory block
          *
-         * Represents a single contiguous memory buffer owned by the arena.
-         * Memory inside the block is consumed linearly.
+         * The header is placed at the beginning of the upstream buffer
+         * it describes, and blocks are chained intrusively from the newest
+         * to the oldest one. Growing the arena therefore costs exactly one
+         * upstream allocation, and the header of the current block shares
+         * cache lines with the memory being handed out.
+         *
+         * Usable memory starts right after the header and is consumed
+         * linearly.
          */
-        struct Block
+        struct alignas(std::max_align_t) Block
         {
-            /// Raw memory buffer
-            std::byte* buffer;
-
-            /// Number of bytes already used in the buffer
-            std::size_t used = 0;
+            /// Previously allocated (older) block, nullptr for the first one
+            Block* prev;
 
-            /// Total buffer capacity in bytes
+            /// Usable capacity in bytes (excluding the header)
             std::size_t capacity;
 
-            /**
-             * @brief Constructs a block with given capacity
-             *
-             * @param cap Size of the block in bytes
-             *
-             * @throws std::bad_alloc if memory allocation fails
-             */
-            explicit Block(std::size_t cap)
-                    : buffer(static_cast<std::byte*>(::operator new(cap)))
-                    , capacity(cap)
-            {}
-
-            /**
-             * @brief Releases the owned memory buffer
-             */
-            ~Block()
+            /// Returns pointer to the first usable byte of the block
+            std::byte* data() noexcept
             {
-                ::operator delete(buffer);
+                return reinterpret_cast<std::byte*>(this + 1);
             }
         };
 
+        /**
+         * @brief Header of a dedicated large allocation
+         *
+         * Placed immediately before the aligned payload. Large
+         * allocations form a circular doubly-linked list around a
+         * sentinel stored in the arena, so each one can be released
+         * individually in O(1) without knowing which arena's list it
+         * is in (see adopt()).
+         */
+        struct alignas(std::max_align_t) LargeBlock
+        {
+            LargeBlock* prev;
+            LargeBlock* next;
+
+            /// Start of the upstream allocation
+            void* raw;
+
+            /// Size of the upstream allocation in bytes
+            std::size_t bytes;
+        };
+
+        /**
+         * @brief Unused tail of a retired block
+         *
+         * Stored in-place at the start of the free range it describes.
+         * Tails are kept in singly-linked buckets by floor(log2) of
+         * their size in bytes.
+         */
+        struct Tail
+        {
+            /// Next tail in the same bucket
+            Tail* next;
+
+            /// End of the free range
+            std::byte* end;
+        };
+
+        /// Number of tail buckets (one per power of two of free bytes)
+        static constexpr std::size_t tail_buckets = 64;
+
     public:
+        /// Tails smaller than this (in bytes) are not worth indexing
+        static constexpr std::size_t min_tail = 64;
+
+        /// Upper bound for block sizes reached through geometric growth
+        static constexpr std::size_t max_block_size = std::size_t{1} << 30;
+
+        /// Minimal threshold above which requests are allocated directly
+        static constexpr std::size_t min_large_threshold = 4096;
+
+        /**
+         * @brief Largest request that can be served with an alignment
+         *
+         * Leaves room for the header and alignment padding of a
+         * dedicated large allocation, so its size cannot wrap around.
+         */
+        static constexpr std::size_t max_request(std::size_t alignment) noexcept
+        {
+            return std::numeric_limits<std::size_t>::max() - sizeof(LargeBlock) -
+                   (std::max)(alignment, alignof(LargeBlock));
+        }
+
+        /// Cache-line size assumed by block coloring
+        static constexpr std::size_t cache_line = 64;
+
+        /// Number of distinct block start offsets used by block coloring
+        static constexpr std::size_t cache_colors = 16;
+
         /**
          * @brief Constructs arena with an initial block
          *
+         * If block_size is zero, no memory is allocated up front and
+         * every block is sized by the request that triggers it.
+         *
+         * Unless given explicitly, the large-allocation threshold is
+         * half of block_size, but not less than min_large_threshold.
+         *
+         * Every time a new block is appended, the default block size is
+         * multiplied by growth_factor (capped at max_block_size).
+         *
          * @param block_size Default size of newly allocated blocks (in bytes)
+         * @param large_threshold Requests above this size (in bytes) get
+         *                        a dedicated allocation (0 selects default)
+         * @param upstream Source of block memory (must outlive the arena)
+         * @param growth_factor Block size multiplier applied on growth
+         *                      (values below 1 are treated as 1)
          */
-        explicit Arena(std::size_t block_size)
-                : block_size(block_size)
+        explicit Arena(std::size_t block_size,
+                       std::size_t large_threshold = 0,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(),
+                       double growth_factor = 1.0)
+                : upstream_(upstream)
+                , page_backed_(is_page_backed(upstream))
+                , block_size(block_size)
+                , growth_factor_((std::max)(growth_factor, 1.0))
+                , large_threshold_(large_threshold
+                                   ? large_threshold
+                                   : default_large_threshold(block_size))
         {
-            add_block(block_size);
+            if (block_size > 0)
+            {
+                add_block(block_size);
+                grow_block_size();
+            }
         }
 
+        /**
+         * @brief Constructs arena over a caller-provided buffer
+         *
+         * The buffer is used as the first block but is not owned: it is
+         * never released and must outlive the arena. Once it is
+         * exhausted, blocks of block_size bytes are obtained from
+         * upstream; pass std::pmr::null_memory_resource() to make
+         * exhaustion throw std::bad_alloc instead.
+         *
+         * Unless given explicitly, the large-allocation threshold is the
+         * buffer size, or the default for block_size if that is larger,
+         * so every request that fits into the buffer is served from it
+         * rather than by a dedicated upstream allocation.
+         *
+         * @param buffer Memory used before any upstream allocation
+         * @param block_size Default size of upstream blocks (in bytes)
+         * @param large_threshold Requests above this size (in bytes) get
+         *                        a dedicated allocation (0 selects default)
+         * @param upstream Source of block memory (must outlive the arena)
+         * @param growth_factor Block size multiplier applied on growth
+         *                      (values below 1 are treated as 1)
+         */
+        Arena(std::span<std::byte> buffer,
+              std::size_t block_size,
+              std::size_t large_threshold = 0,
+              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(),
+              double growth_factor = 1.0)
+                : upstream_(upstream)
+                , page_backed_(is_page_backed(upstream))
+                , block_size(block_size)
+                , growth_factor_((std::max)(growth_factor, 1.0))
+                , large_threshold_(large_threshold
+                                   ? large_threshold
+                                   : (std::max)(default_large_threshold(block_size), buffer.size()))
+                , cur_(buffer.data())
+                , end_(buffer.data() + buffer.size())
+                , buffer_begin_(cur_)
+                , buffer_end_(end_)
+        {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
         /**
          * @brief Destroys the arena and releases all allocated memory
          */
-        ~Arena() = default;
+        ~Arena()
+        {
+            provisioner_.reset();
+
+            while (large_.next != &large_)
+                release_large(large_.next);
+
+            while (head_)
+            {
+                Block* prev = head_->prev;
+                upstream_->deallocate(head_, sizeof(Block) + head_->capacity, alignof(Block));
+                head_ = prev;
+            }
+        }
+
+        /**
+         * @brief Allocates raw memory with a compile-time alignment
+         *
+         * Fast path used by allocators that know the alignment statically.
+         * The alignment is validated at compile time, so the common case
+         * is a single mask-and-bump inside the current block with no
+         * exception paths. Only when the current block is exhausted
+         * the out-of-line growth path is taken.
+         *
+         * @tparam Align Required alignment (must be a power of two)
+         *
+         * @param size Number of bytes to allocate
+         *
+         * @return Pointer to aligned memory block
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        template<std::size_t Align>
+        void* allocate_bytes(std::size_t size)
+        {
+            static_assert(Align != 0 && (Align & (Align - 1)) == 0,
+                          "alignment must be power of two");
+
+            if (size > large_threshold_) [[unlikely]]
+                return allocate_large(size, Align);
+
+            if (void* ptr = bump(size, Align)) [[likely]]
+                return ptr;
+
+            return allocate_from_new_block(size, Align);
+        }
 
         /**
          * @brief Allocates a block of raw memory with specified alignment
@@ -106,38 +318,786 @@ namespace my_allocator::detail
             if (alignment == 0 || (alignment & (alignment - 1)) != 0)
                 throw std::invalid_argument("alignment must be power of two");
 
-            for (;;)
+            if (size > large_threshold_)
+                return allocate_large(size, alignment);
+
+            if (void* ptr = bump(size, alignment))
+                return ptr;
+
+            return allocate_from_new_block(size, alignment);
+        }
+
+        /**
+         * @brief Allocates from existing memory only, without growing
+         *
+         * Serves the request from the current block or an indexed tail.
+         * Never takes memory from upstream, so it cannot throw.
+         *
+         * @tparam Align Required alignment (must be a power of two)
+         *
+         * @param size Number of bytes to allocate
+         *
+         * @return Pointer to aligned memory, or nullptr if the request
+         *         does not fit or exceeds the large-allocation threshold
+         */
+        template<std::size_t Align>
+        void* try_allocate_bytes(std::size_t size) noexcept
+        {
+            static_assert(Align != 0 && (Align & (Align - 1)) == 0,
+                          "alignment must be power of two");
+
+            if (size > large_threshold_) [[unlikely]]
+                return nullptr;
+
+            if (void* ptr = bump(size, Align)) [[likely]]
+                return ptr;
+
+            if (mark_end_)
+            {
+                pass_provisioning_mark();
+
+                if (void* ptr = bump(size, Align))
+                    return ptr;
+            }
+
+            return allocate_from_tail(size, Align);
+        }
+
+        /**
+         * @brief Checks whether memory belongs to the caller-provided buffer
+         *
+         * @param ptr Pointer to check
+         *
+         * @return true if ptr lies inside the buffer passed to the
+         *         constructor (always false for arenas without one)
+         */
+        [[nodiscard]] bool in_buffer(const void* ptr) const noexcept
+        {
+            const auto p = reinterpret_cast<std::uintptr_t>(ptr);
+
+            return p >= reinterpret_cast<std::uintptr_t>(buffer_begin_) &&
+                   p <  reinterpret_cast<std::uintptr_t>(buffer_end_);
+        }
+
+        /**
+         * @brief Releases memory returned by allocate_bytes()
+         *
+         * Dedicated large allocations are returned upstream immediately.
+         * Memory from ordinary blocks is not reclaimed (monotonic model).
+         *
+         * @param ptr Pointer previously returned by allocate_bytes()
+         * @param size Size passed to allocate_bytes()
+         */
+        void deallocate_bytes(void* ptr, std::size_t size) noexcept
+        {
+            if (size > large_threshold_)
+                release_large(reinterpret_cast<LargeBlock*>(ptr) - 1);
+        }
+
+        /**
+         * @brief Drops the pages of a free range inside an allocation
+         *
+         * Lets reusing resources trim memory that deallocate_bytes()
+         * cannot release (anything below the large threshold). The
+         * whole pages inside [begin, end) are handed back to the OS with
+         * madvise(MADV_DONTNEED); they stay mapped and read back as
+         * zeroes. Has no effect unless upstream is page-backed.
+         *
+         * @return Number of bytes handed back to the OS
+         */
+        std::size_t discard(void* begin, void* end) noexcept
+        {
+            if (!page_backed_)
+                return 0;
+
+            return discard_pages(static_cast<std::byte*>(begin), static_cast<std::byte*>(end));
+        }
+
+        /// Returns the upstream memory resource
+        [[nodiscard]] std::pmr::memory_resource* upstream() const noexcept
+        {
+            return upstream_;
+        }
+
+        /// Returns the large-allocation threshold in bytes
+        [[nodiscard]] std::size_t large_threshold() const noexcept
+        {
+            return large_threshold_;
+        }
+
+        /**
+         * @brief Returns unused memory to upstream and the OS
+         *
+         * - the current block is released if nothing has been
+         *   allocated from it yet
+         * - with page-backed upstream (detail::MmapResource) the whole
+         *   pages inside the unused tail of the current block and of
+         *   every indexed tail are dropped with madvise(MADV_DONTNEED);
+         *   they stay mapped and read back as zeroes on next use
+         * - a block prepared in the background (see
+         *   enable_provisioning()) is returned to upstream; the next
+         *   growth arms provisioning again
+         *
+         * Dedicated large allocations are not affected: they are already
+         * released individually by deallocate_bytes().
+         *
+         * @return Number of bytes released or handed back to the OS
+         */
+        std::size_t trim() noexcept
+        {
+            std::size_t released = provisioner_ ? provisioner_->release() : 0;
+
+            if (head_ && block_start_ && cur_ == block_start_)
             {
-                Block* b = blocks.back().get();
+                Block* b = head_;
+                head_ = b->prev;
+                cur_ = end_ = mark_end_ = block_start_ = nullptr;
+
+                if (oldest_ == b)
+                    oldest_ = nullptr;
+
+                released += sizeof(Block) + b->capacity;
+                upstream_->deallocate(b, sizeof(Block) + b->capacity, alignof(Block));
+            }
 
-                void* ptr = b->buffer + b->used;
-                std::size_t space = b->capacity - b->used;
+            if (page_backed_)
+            {
+                if (!in_buffer(cur_))
+                    released += discard_pages(cur_, block_end());
 
-                if (std::align(alignment, size, ptr, space))
+                for (Tail* head : tails_)
                 {
-                    b->used = b->capacity - space + size;
-                    return ptr;
+                    for (Tail* t = head; t; t = t->next)
+                        released += discard_pages(reinterpret_cast<std::byte*>(t + 1), t->end);
+                }
+            }
+
+            return released;
+        }
+
+        /**
+         * @brief Takes ownership of all memory of another arena in O(1)
+         *
+         * Blocks and dedicated large allocations of other are spliced
+         * into this arena's lists, so everything allocated from other
+         * stays valid for the lifetime of this arena. The unused part of
+         * other's current block and its indexed tails become available
+         * for reuse here (only the first tail of each size bucket when
+         * both arenas have tails of that size, to stay O(1)).
+         *
+         * Afterwards other owns no memory and may keep allocating from
+         * new blocks of its own, or forward its growth here (see
+         * forward_to()). Memory allocated from other may be passed to
+         * this arena's deallocate_bytes() and vice versa.
+         *
+         * @param other Arena to take memory from
+         *
+         * @throws std::invalid_argument if other is this arena, uses a
+         *         caller-provided buffer, a different upstream or a
+         *         different large-allocation threshold
+         */
+        void adopt(Arena& other)
+        {
+            if (&other == this || other.buffer_begin_ ||
+                !upstream_->is_equal(*other.upstream_) ||
+                large_threshold_ != other.large_threshold_)
+                throw std::invalid_argument("arena cannot be adopted");
+
+            if (other.head_)
+            {
+                if (head_)
+                {
+                    // Keep our current block at the head of the list
+                    other.oldest_->prev = head_->prev;
+                    head_->prev = other.head_;
+
+                    if (oldest_ == head_)
+                        oldest_ = other.oldest_;
+                }
+                else
+                {
+                    head_ = other.head_;
+                    oldest_ = other.oldest_;
                 }
+            }
+
+            if (other.large_.next != &other.large_)
+            {
+                LargeBlock* first = other.large_.next;
+                LargeBlock* last = other.large_.prev;
+
+                last->next = large_.next;
+                large_.next->prev = last;
+                large_.next = first;
+                first->prev = &large_;
+            }
+
+            retire_tail(other.cur_, other.block_end());
 
-                add_block((std::max)(block_size, size + alignment));
+            for (std::size_t i = 0; i < tail_buckets; ++i)
+            {
+                Tail* t = other.tails_[i];
+
+                if (!t)
+                    continue;
+
+                if (!tails_[i])
+                {
+                    tails_[i] = t;
+                }
+                else
+                {
+                    other.tails_[i] = t->next;
+                    t->next = tails_[i];
+                    tails_[i] = t;
+                }
             }
+
+            tails_mask_ |= other.tails_mask_;
+
+            other.head_ = other.oldest_ = nullptr;
+            other.large_.next = other.large_.prev = &other.large_;
+            other.cur_ = other.end_ = other.mark_end_ = other.block_start_ = nullptr;
+            other.tails_mask_ = 0;
+
+            for (Tail*& t : other.tails_)
+                t = nullptr;
+        }
+
+        /**
+         * @brief Redirects all further growth to another arena
+         *
+         * Requests that do not fit into memory this arena already has
+         * are served by target, which is kept alive by this arena. Used
+         * after target.adopt(*this), so memory allocated later by this
+         * arena's users is owned by target too.
+         *
+         * Growth carves block-sized chunks from target that this arena
+         * then bump-allocates from, so the fast path keeps working; large
+         * allocations are made by target directly. Both therefore modify
+         * target without synchronization: this arena must not be used
+         * concurrently with target (e.g. the thread that filled it must
+         * be idle or hand its allocations over to target's thread).
+         *
+         * @param target Arena to forward to
+         */
+        void forward_to(std::shared_ptr<Arena> target) noexcept
+        {
+            forward_ = std::move(target);
+        }
+
+        /// Arena receiving further growth, or nullptr
+        [[nodiscard]] const std::shared_ptr<Arena>& forwarded_to() const noexcept
+        {
+            return forward_;
+        }
+
+        /**
+         * @brief Prepares upcoming blocks on a background thread
+         *
+         * Once fill_ratio of the current block is used, a worker thread
+         * shared by all provisioned arenas allocates the next block from
+         * upstream and pre-faults its pages. When the arena grows, the
+         * prepared block is swapped in instead of calling upstream on
+         * the allocating thread. The fast
+         * path is unaffected: the fill mark is enforced by holding back
+         * the end of the current block until the slow path is entered.
+         *
+         * Upstream is then used from two threads and must be
+         * thread-safe (true for new_delete, MmapResource and
+         * BlockCache). Has no effect for arenas without upstream growth
+         * (block_size of 0) or when already enabled.
+         *
+         * @param fill_ratio Used fraction of a block (0, 1] that triggers
+         *                   preparation of the next one
+         */
+        void enable_provisioning(double fill_ratio = 0.5)
+        {
+            if (provisioner_ || block_size == 0)
+                return;
+
+            fill_ratio_ = std::clamp(fill_ratio, 0.0, 1.0);
+            provisioner_ = std::make_unique<BlockProvisioner>(upstream_, alignof(Block));
+
+            if (head_ && !in_buffer(cur_))
+                arm_provisioning_mark();
+            else
+                provisioner_->request(sizeof(Block) + provisioned_capacity());
+        }
+
+        /// Number of growths served by a block prepared in the background
+        [[nodiscard]] std::size_t provisioned_blocks() const
+        {
+            return provisioner_ ? provisioner_->taken() : 0;
+        }
+
+        /**
+         * @brief Staggers the start of every block by a cache-line color
+         *
+         * Blocks obtained from upstream tend to start at the same offset
+         * within a page, so the first objects of many arenas compete for
+         * the same cache sets. With coloring, the cursor of each new
+         * block skips a multiple of cache_line bytes chosen from a
+         * process-wide rotation of cache_colors colors. At most an
+         * eighth of a block is skipped; the skipped bytes are not used.
+         *
+         * The current block is colored too if nothing has been
+         * allocated from it yet. A caller-provided buffer is left as is.
+         */
+        void enable_coloring() noexcept
+        {
+            if (coloring_)
+                return;
+
+            coloring_ = true;
+
+            if (head_ && block_start_ && cur_ == block_start_)
+                color_block(0);
         }
 
     private:
+        /// Whether upstream hands out whole anonymous pages
+        static bool is_page_backed(std::pmr::memory_resource* upstream) noexcept
+        {
+            return MmapResource::page_backed &&
+                   dynamic_cast<MmapResource*>(upstream) != nullptr;
+        }
+
+        /**
+         * @brief Drops the whole pages inside a free range
+         *
+         * @return Number of bytes handed back to the OS
+         */
+        static std::size_t discard_pages(std::byte* begin, std::byte* end) noexcept
+        {
+#if MY_ALLOCATOR_HAS_MMAP
+            const std::size_t page = MmapResource::page_size();
+
+            const auto first = (reinterpret_cast<std::uintptr_t>(begin) + page - 1) & ~(page - 1);
+            const auto last = reinterpret_cast<std::uintptr_t>(end) & ~(page - 1);
+
+            if (!begin || first >= last)
+                return 0;
+
+            if (::madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED) != 0)
+                return 0;
+
+            return last - first;
+#else
+            (void)begin;
+            (void)end;
+            return 0;
+#endif
+        }
+
+        /**
+         * @brief Advances the cursor of a fresh upstream block by its color
+         *
+         * @param need Bytes that must still fit after the offset
+         */
+        void color_block(std::size_t need) noexcept
+        {
+            static std::atomic<std::size_t> rotation{0};
+
+            const auto free = static_cast<std::size_t>(end_ - cur_);
+            const std::size_t colors = (std::min)(cache_colors, free / 8 / cache_line + 1);
+            const std::size_t offset =
+                    rotation.fetch_add(1, std::memory_order_relaxed) % colors * cache_line;
+
+            if (offset == 0 || free - offset < need)
+                return;
+
+            cur_ += offset;
+            block_start_ = cur_;
+        }
+
+        /// End of the current block, even while end_ is held back
+        [[nodiscard]] std::byte* block_end() const noexcept
+        {
+            return mark_end_ ? mark_end_ : end_;
+        }
+
+        /**
+         * @brief Holds end_ back at the provisioning fill mark
+         *
+         * Called once a fresh upstream block has become current.
+         */
+        void arm_provisioning_mark() noexcept
+        {
+            const auto usable = static_cast<std::size_t>(end_ - cur_);
+
+            mark_end_ = end_;
+            end_ = cur_ + static_cast<std::size_t>(static_cast<double>(usable) * fill_ratio_);
+        }
+
+        /**
+         * @brief Releases the held-back end and requests the next block
+         */
+        void pass_provisioning_mark() noexcept
+        {
+            end_ = mark_end_;
+            mark_end_ = nullptr;
+
+            if (!forward_)
+                provisioner_->request(sizeof(Block) + provisioned_capacity());
+        }
+
+        /**
+         * @brief Capacity of the next block to prepare
+         *
+         * Growth requests larger than block_size tend to repeat (e.g.
+         * nodes bigger than a small policy block), so the last one is
+         * used as the estimate.
+         */
+        [[nodiscard]] std::size_t provisioned_capacity() const noexcept
+        {
+            return (std::max)(block_size, last_growth_need_);
+        }
+
+        /// Default large-allocation threshold for a given block size
+        static constexpr std::size_t default_large_threshold(std::size_t block_size) noexcept
+        {
+            return (std::max)(block_size / 2, min_large_threshold);
+        }
+
+        /**
+         * @brief Bumps the cursor of the current block
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory, or nullptr if the current
+         *         block cannot satisfy the request
+         */
+        void* bump(std::size_t size, std::size_t alignment) noexcept
+        {
+            const auto cur = reinterpret_cast<std::uintptr_t>(cur_);
+            const auto end = reinterpret_cast<std::uintptr_t>(end_);
+            const auto aligned = (cur + alignment - 1) & ~(alignment - 1);
+
+            if (aligned > end || size > end - aligned)
+                return nullptr;
+
+            cur_ = reinterpret_cast<std::byte*>(aligned + size);
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        /**
+         * @brief Slow path: reuses an indexed tail or appends a new block
+         *
+         * Never inlined and marked cold, so the fast path stays small.
+         * The tail of the current block is indexed once its replacement
+         * exists.
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory block
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        MY_ALLOCATOR_COLD
+        void* allocate_from_new_block(std::size_t size, std::size_t alignment)
+        {
+            if (mark_end_)
+            {
+                pass_provisioning_mark();
+
+                if (void* ptr = bump(size, alignment))
+                    return ptr;
+            }
+
+            if (void* ptr = allocate_from_tail(size, alignment))
+                return ptr;
+
+            if (forward_) [[unlikely]]
+                return allocate_from_forwarded_chunk(size, alignment);
+
+            // Index the old tail only once the new block exists: if
+            // upstream throws, the current block stays current
+            std::byte* const old_cur = cur_;
+            std::byte* const old_end = end_;
+
+            add_block((std::max)(block_size, size + alignment));
+            retire_tail(old_cur, old_end);
+            grow_block_size();
+            last_growth_need_ = size + alignment;
+
+            if (coloring_)
+                color_block(size + alignment);
+
+            void* ptr = bump(size, alignment);
+
+            if (provisioner_)
+                arm_provisioning_mark();
+
+            return ptr;
+        }
+
+        /**
+         * @brief Growth path of an arena that forwards to another one
+         *
+         * A chunk of block_size bytes is carved from the target and
+         * becomes the current block, so following requests are bump
+         * allocated here again. The chunk is owned by the target;
+         * requests that do not fit into one go to the target directly.
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory block
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        MY_ALLOCATOR_COLD
+        void* allocate_from_forwarded_chunk(std::size_t size, std::size_t alignment)
+        {
+            const std::size_t chunk = block_size;
+
+            if (size + alignment > chunk)
+                return forward_->allocate_bytes(size, alignment);
+
+            auto* raw = static_cast<std::byte*>(
+                    forward_->allocate_bytes(chunk, alignof(std::max_align_t)));
+
+            retire_tail(cur_, end_);
+            grow_block_size();
+
+            cur_ = raw;
+            end_ = raw + chunk;
+
+            return bump(size, alignment);
+        }
+
+        /**
+         * @brief Applies the growth factor to the default block size
+         */
+        void grow_block_size() noexcept
+        {
+            if (growth_factor_ == 1.0 || block_size >= max_block_size)
+                return;
+
+            const double next = static_cast<double>(block_size) * growth_factor_;
+
+            block_size = next >= static_cast<double>(max_block_size)
+                         ? max_block_size
+                         : static_cast<std::size_t>(next);
+        }
+
+        /**
+         * @brief Serves a request from an indexed block tail
+         *
+         * Only buckets whose every tail is guaranteed to fit the request
+         * (including worst-case alignment padding) are considered, so
+         * the lookup is a single bitmap scan.
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory, or nullptr if no tail fits
+         */
+        void* allocate_from_tail(std::size_t size, std::size_t alignment) noexcept
+        {
+            if (tails_mask_ == 0)
+                return nullptr;
+
+            const std::size_t need = size + alignment - 1;
+            const auto k = static_cast<std::size_t>(std::bit_width(need - 1));
+
+            if (k >= tail_buckets)
+                return nullptr;
+
+            const std::uint64_t fit = tails_mask_ & (~std::uint64_t{0} << k);
+
+            if (fit == 0)
+                return nullptr;
+
+            const auto i = static_cast<std::size_t>(std::countr_zero(fit));
+
+            Tail* t = tails_[i];
+            tails_[i] = t->next;
+
+            if (!tails_[i])
+                tails_mask_ &= ~(std::uint64_t{1} << i);
+
+            std::byte* end = t->end;
+
+            const auto begin = reinterpret_cast<std::uintptr_t>(t);
+            const auto aligned = (begin + alignment - 1) & ~(alignment - 1);
+
+            auto* rest = reinterpret_cast<std::byte*>(aligned + size);
+            retire_tail(rest, end);
+
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        /**
+         * @brief Indexes a free range for later reuse
+         *
+         * Ranges smaller than min_tail are dropped.
+         *
+         * @param begin Start of the free range
+         * @param end End of the free range
+         */
+        void retire_tail(std::byte* begin, std::byte* end) noexcept
+        {
+            const auto first = reinterpret_cast<std::uintptr_t>(begin);
+            const auto aligned = (first + alignof(Tail) - 1) & ~(alignof(Tail) - 1);
+            const auto last = reinterpret_cast<std::uintptr_t>(end);
+
+            if (aligned > last || last - aligned < min_tail)
+                return;
+
+            const std::size_t free = last - aligned;
+            const auto i = static_cast<std::size_t>(std::bit_width(free)) - 1;
+
+            tails_[i] = ::new (reinterpret_cast<void*>(aligned)) Tail{tails_[i], end};
+            tails_mask_ |= std::uint64_t{1} << i;
+        }
+
+        /**
+         * @brief Allocates a dedicated block for a large request
+         *
+         * Never inlined and marked cold, like allocate_from_new_block().
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory block
+         *
+         * @throws std::bad_alloc if size exceeds max_request() or memory
+         *         allocation fails
+         */
+        MY_ALLOCATOR_COLD
+        void* allocate_large(std::size_t size, std::size_t alignment)
+        {
+            if (forward_) [[unlikely]]
+                return forward_->allocate_bytes(size, alignment);
+
+            if (size > max_request(alignment))
+                throw std::bad_alloc{};
+
+            const std::size_t align = (std::max)(alignment, alignof(LargeBlock));
+            const std::size_t bytes = sizeof(LargeBlock) + size + align;
+            void* raw = upstream_->allocate(bytes, alignof(LargeBlock));
+
+            const auto first = reinterpret_cast<std::uintptr_t>(raw) + sizeof(LargeBlock);
+            const auto payload = (first + align - 1) & ~(align - 1);
+
+            auto* block = ::new (reinterpret_cast<void*>(payload - sizeof(LargeBlock)))
+                    LargeBlock{&large_, large_.next, raw, bytes};
+
+            large_.next->prev = block;
+            large_.next = block;
+
+            return block + 1;
+        }
+
+        /**
+         * @brief Unlinks and frees a dedicated large block
+         *
+         * @param block Header of the large block
+         */
+        void release_large(LargeBlock* block) noexcept
+        {
+            block->prev->next = block->next;
+            block->next->prev = block->prev;
+
+            upstream_->deallocate(block->raw, block->bytes, alignof(LargeBlock));
+        }
+
         /**
-         * @brief Allocates and appends a new memory block
+         * @brief Allocates and links a new memory block
+         *
+         * Header and usable memory are obtained with a single upstream
+         * allocation. The new block becomes the current one. A prepared
+         * block larger than cap is used in full.
+         *
+         * @param cap Usable capacity of the new block in bytes
          *
-         * @param cap Capacity of the new block in bytes
+         * @throws std::bad_alloc if memory allocation fails
          */
         void add_block(std::size_t cap)
         {
-            blocks.emplace_back(std::make_unique<Block>(cap));
+            std::size_t bytes = sizeof(Block) + cap;
+            void* raw = provisioner_ ? provisioner_->take(bytes) : nullptr;
+
+            if (raw)
+                cap = bytes - sizeof(Block);
+            else
+                raw = upstream_->allocate(sizeof(Block) + cap, alignof(Block));
+
+            Block* b = ::new (raw) Block{head_, cap};
+            head_ = b;
+
+            if (!oldest_)
+                oldest_ = b;
+
+            cur_ = block_start_ = b->data();
+            end_ = b->data() + b->capacity;
         }
 
-        /// List of allocated memory blocks
-        std::vector<std::unique_ptr<Block>> blocks;
+        /// Source of block and large-allocation memory
+        std::pmr::memory_resource* upstream_;
+
+        /// Whether blocks are anonymous pages that may be madvise'd
+        bool page_backed_;
+
+        /// Newest (current) block, head of the intrusive block list
+        Block* head_ = nullptr;
+
+        /// Oldest block, tail of the intrusive block list
+        Block* oldest_ = nullptr;
+
+        /// Sentinel of the circular list of dedicated large allocations
+        LargeBlock large_{&large_, &large_, nullptr, 0};
+
+        /// Arena receiving all further growth after adopt() (see forward_to())
+        std::shared_ptr<Arena> forward_;
 
         /// Default block size for new blocks
         std::size_t block_size;
+
+        /// Multiplier applied to block_size whenever a block is appended
+        double growth_factor_;
+
+        /// Requests above this size get a dedicated allocation
+        std::size_t large_threshold_;
+
+        /// Allocation cursor inside the current block
+        std::byte* cur_ = nullptr;
+
+        /// End of the current block (the fill mark while provisioning)
+        std::byte* end_ = nullptr;
+
+        /// Real end of the current block while end_ is held back, or nullptr
+        std::byte* mark_end_ = nullptr;
+
+        /// Used fraction of a block that triggers provisioning
+        double fill_ratio_ = 1.0;
+
+        /// Capacity needed by the last growth (see provisioned_capacity())
+        std::size_t last_growth_need_ = 0;
+
+        /// Prepares blocks in the background (see enable_provisioning())
+        std::unique_ptr<BlockProvisioner> provisioner_;
+
+        /// First usable byte of the current upstream block (after coloring)
+        std::byte* block_start_ = nullptr;
+
+        /// Whether new blocks are colored (see enable_coloring())
+        bool coloring_ = false;
+
+        /// Caller-provided buffer (empty if none)
+        std::byte* buffer_begin_ = nullptr;
+        std::byte* buffer_end_   = nullptr;
+
+        /// Heads of the tail buckets, indexed by floor(log2(free bytes))
+        Tail* tails_[tail_buckets] = {};
+
+        /// Bit i is set when tails_[i] is not empty
+        std::uint64_t tails_mask_ = 0;
     };
 }
+
+#undef MY_ALLOCATOR_COLD
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "MmapResource.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Background preparation of the next arena block
+     *
+     * Blocks are obtained from upstream ahead of time and pre-faulted by
+     * touching every page, so the arena's growth path only swaps in
+     * memory that is already mapped. At most one block is prepared per
+     * provisioner at a time.
+     *
+     * All provisioners share one worker thread, which serves their
+     * requests in FIFO order. The worker exists while at least one
+     * provisioner does.
+     *
+     * The arena posts a request once its current block passes a fill
+     * mark and takes the block when it actually grows. A prepared block
+     * that is too small for the growth request is released rather than
+     * kept, and a request for a different size replaces it, so a
+     * mismatch never pins memory or stalls provisioning.
+     *
+     * @note request() and take() must be called by the arena's owning
+     *       thread; upstream is used concurrently from the worker and
+     *       must be thread-safe
+     */
+    class BlockProvisioner
+    {
+        /**
+         * @brief Worker thread shared by every provisioner
+         *
+         * The mutex protects the queue as well as the request and
+         * prepared-block state of every provisioner.
+         */
+        struct Worker
+        {
+            Worker()
+                    : thread([this] { run(); })
+            {}
+
+            Worker(const Worker&) = delete;
+            Worker& operator=(const Worker&) = delete;
+
+            ~Worker()
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    stop = true;
+                }
+
+                wake.notify_one();
+                thread.join();
+            }
+
+            /// Returns the running worker, starting one if needed
+            static std::shared_ptr<Worker> shared()
+            {
+                static std::mutex mutex;
+                static std::weak_ptr<Worker> current;
+
+                std::lock_guard lock(mutex);
+
+                auto worker = current.lock();
+                if (!worker)
+                {
+                    worker = std::make_shared<Worker>();
+                    current = worker;
+                }
+
+                return worker;
+            }
+
+            /// Appends a provisioner to the queue (mutex must be held)
+            void push(BlockProvisioner* p) noexcept
+            {
+                p->queued_next_ = nullptr;
+
+                if (tail)
+                    tail->queued_next_ = p;
+                else
+                    head = p;
+
+                tail = p;
+            }
+
+            /// Removes a provisioner from the queue (mutex must be held)
+            void remove(BlockProvisioner* p) noexcept
+            {
+                BlockProvisioner* prev = nullptr;
+
+                for (BlockProvisioner* q = head; q; prev = q, q = q->queued_next_)
+                {
+                    if (q != p)
+                        continue;
+
+                    (prev ? prev->queued_next_ : head) = q->queued_next_;
+
+                    if (tail == q)
+                        tail = prev;
+
+                    return;
+                }
+            }
+
+            /// Serves queued requests until stopped
+            void run()
+            {
+                std::unique_lock lock(mutex);
+
+                for (;;)
+                {
+                    wake.wait(lock, [this] { return stop || head; });
+
+                    if (stop)
+                        return;
+
+                    BlockProvisioner* p = head;
+                    head = p->queued_next_;
+                    if (!head)
+                        tail = nullptr;
+
+                    busy = p;
+                    const std::size_t bytes = p->requested_;
+                    lock.unlock();
+
+                    void* block = nullptr;
+
+                    try
+                    {
+                        block = p->upstream_->allocate(bytes, p->alignment_);
+                        prefault(static_cast<std::byte*>(block), bytes);
+                    }
+                    catch (...)
+                    {
+                        // The arena's growth path allocates (and reports
+                        // failure) itself
+                    }
+
+                    lock.lock();
+                    busy = nullptr;
+                    p->requested_ = 0;
+
+                    if (block)
+                    {
+                        p->ready_ = block;
+                        p->ready_bytes_ = bytes;
+                    }
+
+                    idle.notify_all();
+                }
+            }
+
+            std::mutex mutex;
+
+            /// Signalled when a request is queued or on stop
+            std::condition_variable wake;
+
+            /// Signalled when a request has been served
+            std::condition_variable idle;
+
+            /// Queue of provisioners with a pending request
+            BlockProvisioner* head = nullptr;
+            BlockProvisioner* tail = nullptr;
+
+            /// Provisioner whose request is being served, or nullptr
+            BlockProvisioner* busy = nullptr;
+
+            bool stop = false;
+
+            /// Started last, once every member above is initialized
+            std::thread thread;
+        };
+
+    public:
+        /**
+         * @brief Attaches to the shared worker
+         *
+         * @param upstream Source of prepared blocks (must be thread-safe
+         *                 and outlive the provisioner)
+         * @param alignment Alignment of prepared blocks
+         */
+        BlockProvisioner(std::pmr::memory_resource* upstream, std::size_t alignment)
+                : upstream_(upstream),
+                  alignment_(alignment),
+                  worker_(Worker::shared())
+        {}
+
+        BlockProvisioner(const BlockProvisioner&) = delete;
+        BlockProvisioner& operator=(const BlockProvisioner&) = delete;
+
+        /**
+         * @brief Withdraws a pending request and releases an unclaimed block
+         *
+         * Waits if the worker is currently preparing a block for this
+         * provisioner.
+         */
+        ~BlockProvisioner()
+        {
+            void* block;
+            std::size_t bytes;
+
+            {
+                std::unique_lock lock(worker_->mutex);
+
+                worker_->remove(this);
+                worker_->idle.wait(lock, [this] { return worker_->busy != this; });
+
+                block = ready_;
+                bytes = ready_bytes_;
+            }
+
+            if (block)
+                upstream_->deallocate(block, bytes, alignment_);
+        }
+
+        /**
+         * @brief Asks the worker to prepare a block
+         *
+         * Ignored while a request is pending or a block of the same size
+         * is prepared. A prepared block of another size is released.
+         *
+         * @param bytes Size of the block in bytes
+         */
+        void request(std::size_t bytes) noexcept
+        {
+            void* stale = nullptr;
+            std::size_t stale_bytes = 0;
+
+            {
+                std::lock_guard lock(worker_->mutex);
+
+                if (requested_ || (ready_ && ready_bytes_ == bytes))
+                    return;
+
+                stale = std::exchange(ready_, nullptr);
+                stale_bytes = ready_bytes_;
+
+                requested_ = bytes;
+                worker_->push(this);
+            }
+
+            worker_->wake.notify_one();
+
+            if (stale)
+                upstream_->deallocate(stale, stale_bytes, alignment_);
+        }
+
+        /**
+         * @brief Takes the prepared block if it is large enough
+         *
+         * Never waits for the worker. A prepared block that is too small
+         * is released.
+         *
+         * @param bytes Minimum size in bytes; set to the size of the
+         *              returned block
+         *
+         * @return Prepared block, or nullptr
+         */
+        void* take(std::size_t& bytes) noexcept
+        {
+            void* stale;
+            std::size_t stale_bytes;
+
+            {
+                std::lock_guard lock(worker_->mutex);
+
+                if (!ready_)
+                    return nullptr;
+
+                stale = std::exchange(ready_, nullptr);
+                stale_bytes = ready_bytes_;
+
+                if (stale_bytes >= bytes)
+                {
+                    bytes = stale_bytes;
+                    ++taken_;
+                    return stale;
+                }
+            }
+
+            upstream_->deallocate(stale, stale_bytes, alignment_);
+            return nullptr;
+        }
+
+        /**
+         * @brief Withdraws a pending request and releases the prepared block
+         *
+         * Waits if the worker is currently preparing a block for this
+         * provisioner. The next request() is served as usual.
+         *
+         * @return Size of the released block in bytes (0 if none)
+         */
+        std::size_t release() noexcept
+        {
+            void* block;
+            std::size_t bytes;
+
+            {
+                std::unique_lock lock(worker_->mutex);
+
+                worker_->remove(this);
+                worker_->idle.wait(lock, [this] { return worker_->busy != this; });
+
+                requested_ = 0;
+                block = std::exchange(ready_, nullptr);
+                bytes = ready_bytes_;
+            }
+
+            if (!block)
+                return 0;
+
+            upstream_->deallocate(block, bytes, alignment_);
+            return bytes;
+        }
+
+        /// Number of blocks taken by the arena
+        [[nodiscard]] std::size_t taken() const
+        {
+            std::lock_guard lock(worker_->mutex);
+            return taken_;
+        }
+
+    private:
+        /// Touches every page of a block so it is mapped before use
+        static void prefault(std::byte* block, std::size_t bytes) noexcept
+        {
+            const std::size_t page = MmapResource::page_size();
+
+            for (std::size_t i = 0; i < bytes; i += page)
+                static_cast<volatile std::byte*>(block)[i] = std::byte{0};
+        }
+
+        /// Source of prepared blocks
+        std::pmr::memory_resource* upstream_;
+
+        /// Alignment of prepared blocks
+        std::size_t alignment_;
+
+        /// Shared worker; its mutex protects the members below
+        std::shared_ptr<Worker> worker_;
+
+        /// Next provisioner in the worker queue
+        BlockProvisioner* queued_next_ = nullptr;
+
+        /// Size of the pending request (0 if none)
+        std::size_t requested_ = 0;
+
+        /// Prepared block, or nullptr
+        void* ready_ = nullptr;
+        std::size_t ready_bytes_ = 0;
+
+        std::size_t taken_ = 0;
+    };
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Arena.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Buddy-system memory resource on top of an Arena
+     *
+     * Memory is managed in heaps of HeapSize bytes obtained from the
+     * arena. Each heap is recursively split into power-of-two blocks
+     * from MinBlock up to HeapSize bytes. Allocation takes the smallest
+     * free block that fits, splitting larger ones on demand; deallocation
+     * coalesces a block with its buddy while the buddy is free.
+     *
+     * Both operations are O(log(HeapSize / MinBlock)), plus O(log heaps)
+     * to locate the heap of a freed pointer.
+     *
+     * Requests larger than HeapSize or aligned stricter than HeapAlign
+     * are served by the arena directly.
+     *
+     * @tparam HeapSize Size of one buddy heap (power of two)
+     * @tparam MinBlock Smallest block size (power of two)
+     *
+     * @note This class is not thread-safe
+     * @note The arena must outlive the resource
+     */
+    template<std::size_t HeapSize, std::size_t MinBlock>
+    class BuddyResource
+    {
+        /// Free block, linked through its own storage
+        struct FreeBlock
+        {
+            FreeBlock* prev;
+            FreeBlock* next;
+        };
+
+        static_assert(std::has_single_bit(HeapSize), "heap size must be power of two");
+        static_assert(std::has_single_bit(MinBlock), "block size must be power of two");
+        static_assert(MinBlock >= sizeof(FreeBlock), "block size too small");
+        static_assert(HeapSize >= MinBlock, "heap smaller than block");
+
+        /// Number of distinct block orders
+        static constexpr std::size_t Orders =
+                std::countr_zero(HeapSize) - std::countr_zero(MinBlock) + 1;
+
+        /// Number of MinBlock units in one heap
+        static constexpr std::size_t Units = HeapSize / MinBlock;
+
+        /// Alignment of heap base addresses
+        static constexpr std::size_t HeapAlign = (std::min)(HeapSize, std::size_t{64});
+
+        /**
+         * @brief Heap descriptor
+         *
+         * orders[i] holds (order + 1) of the free block starting at unit i,
+         * or 0 if no free block starts there.
+         */
+        struct Heap
+        {
+            std::byte*    base;
+            std::uint8_t* orders;
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty resource
+         *
+         * No heap is reserved until the first allocation.
+         *
+         * @param arena Arena heaps are carved from
+         */
+        explicit BuddyResource(Arena& arena) noexcept
+                : arena_(arena)
+        {}
+
+        BuddyResource(const BuddyResource&) = delete;
+        BuddyResource& operator=(const BuddyResource&) = delete;
+
+        /**
+         * @brief Allocates a block of at least size bytes
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory block
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            if (!is_buddy_request(size, alignment))
+                return arena_.allocate_bytes(size, alignment);
+
+            const std::size_t order = order_for((std::max)(size, alignment));
+
+            std::size_t k = order;
+            while (k < Orders && !free_[k])
+                ++k;
+
+            if (k == Orders)
+            {
+                add_heap();
+                k = Orders - 1;
+            }
+
+            FreeBlock* block = free_[k];
+            Heap& heap = heap_of(block);
+            unlink(heap, block, k);
+
+            while (k > order)
+            {
+                --k;
+                auto* buddy = reinterpret_cast<std::byte*>(block) + block_size(k);
+                link(heap, reinterpret_cast<FreeBlock*>(buddy), k);
+            }
+
+            return block;
+        }
+
+        /**
+         * @brief Returns a block and coalesces it with free buddies
+         *
+         * @param ptr Pointer previously returned by allocate()
+         * @param size Size passed to allocate()
+         * @param alignment Alignment passed to allocate()
+         */
+        void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+        {
+            if (!is_buddy_request(size, alignment))
+            {
+                arena_.deallocate_bytes(ptr, size);
+                return;
+            }
+
+            std::size_t k = order_for((std::max)(size, alignment));
+
+            Heap& heap = heap_of(ptr);
+            auto offset = static_cast<std::size_t>(static_cast<std::byte*>(ptr) - heap.base);
+
+            while (k + 1 < Orders)
+            {
+                const std::size_t buddy = offset ^ block_size(k);
+
+                if (heap.orders[buddy / MinBlock] != k + 1)
+                    break;
+
+                unlink(heap, reinterpret_cast<FreeBlock*>(heap.base + buddy), k);
+                offset = (std::min)(offset, buddy);
+                ++k;
+            }
+
+            link(heap, reinterpret_cast<FreeBlock*>(heap.base + offset), k);
+        }
+
+        /**
+         * @brief Returns the memory of fully coalesced heaps
+         *
+         * A heap whose single free block spans all of it is released
+         * and forgotten when it was allocated above the arena's large
+         * threshold. Otherwise its pages are handed back to the OS when
+         * the arena is page-backed (see Arena::discard()).
+         *
+         * @return Number of bytes released or handed back to the OS
+         */
+        std::size_t trim() noexcept
+        {
+            constexpr std::size_t bytes = HeapSize + Units;
+            std::size_t released = 0;
+
+            std::erase_if(heaps_, [&](Heap& heap) {
+                if (heap.orders[0] != Orders)
+                    return false;
+
+                auto* block = reinterpret_cast<FreeBlock*>(heap.base);
+
+                if (bytes > arena_.large_threshold())
+                {
+                    unlink(heap, block, Orders - 1);
+                    arena_.deallocate_bytes(heap.base, bytes);
+                    released += bytes;
+                    return true;
+                }
+
+                released += arena_.discard(block + 1, heap.base + HeapSize);
+                return false;
+            });
+
+            return released;
+        }
+
+    private:
+        /// Size of a block of given order
+        static constexpr std::size_t block_size(std::size_t order) noexcept
+        {
+            return MinBlock << order;
+        }
+
+        /// Smallest order whose block holds bytes
+        static std::size_t order_for(std::size_t bytes) noexcept
+        {
+            if (bytes <= MinBlock)
+                return 0;
+
+            return std::bit_width(bytes - 1) - std::countr_zero(MinBlock);
+        }
+
+        /// Whether the request is served by buddy heaps
+        static bool is_buddy_request(std::size_t size, std::size_t alignment) noexcept
+        {
+            return size <= HeapSize && alignment <= HeapAlign;
+        }
+
+        /**
+         * @brief Reserves a new heap from the arena
+         *
+         * Heap memory and its order map are obtained with one request.
+         */
+        void add_heap()
+        {
+            auto* base = static_cast<std::byte*>(
+                    arena_.allocate_bytes(HeapSize + Units, HeapAlign));
+
+            Heap heap{base, reinterpret_cast<std::uint8_t*>(base + HeapSize)};
+            std::memset(heap.orders, 0, Units);
+
+            auto pos = std::upper_bound(
+                    heaps_.begin(), heaps_.end(), base,
+                    [](std::byte* p, const Heap& h) { return p < h.base; });
+
+            Heap& inserted = *heaps_.insert(pos, heap);
+            link(inserted, reinterpret_cast<FreeBlock*>(base), Orders - 1);
+        }
+
+        /// Finds the heap containing ptr
+        Heap& heap_of(void* ptr) noexcept
+        {
+            auto* p = static_cast<std::byte*>(ptr);
+
+            auto it = std::upper_bound(
+                    heaps_.begin(), heaps_.end(), p,
+                    [](std::byte* q, const Heap& h) { return q < h.base; });
+
+            return *(it - 1);
+        }
+
+        /// Pushes a free block of given order
+        void link(Heap& heap, FreeBlock* block, std::size_t order) noexcept
+        {
+            block->prev = nullptr;
+            block->next = free_[order];
+
+            if (block->next)
+                block->next->prev = block;
+
+            free_[order] = block;
+
+            const auto unit = (reinterpret_cast<std::byte*>(block) - heap.base) / MinBlock;
+            heap.orders[unit] = static_cast<std::uint8_t>(order + 1);
+        }
+
+        /// Removes a free block of given order
+        void unlink(Heap& heap, FreeBlock* block, std::size_t order) noexcept
+        {
+            if (block->prev)
+                block->prev->next = block->next;
+            else
+                free_[order] = block->next;
+
+            if (block->next)
+                block->next->prev = block->prev;
+
+            const auto unit = (reinterpret_cast<std::byte*>(block) - heap.base) / MinBlock;
+            heap.orders[unit] = 0;
+        }
+
+        /// Arena providing heap memory
+        Arena& arena_;
+
+        /// Free lists indexed by order
+        std::array<FreeBlock*, Orders> free_{};
+
+        /// Heaps sorted by base address
+        std::vector<Heap> heaps_;
+    };
+}
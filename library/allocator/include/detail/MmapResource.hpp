@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MY_ALLOCATOR_HAS_MMAP 1
+#else
+#define MY_ALLOCATOR_HAS_MMAP 0
+#endif
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Page-granular memory resource backed by anonymous mappings
+     *
+     * Every allocation is a private anonymous mapping rounded up to
+     * whole pages. Arenas on top of this resource know that their
+     * blocks are page-backed, so Arena::trim() may hand unused pages
+     * back to the OS with madvise(MADV_DONTNEED).
+     *
+     * On platforms without mmap it forwards to
+     * std::pmr::new_delete_resource() and is not considered
+     * page-backed.
+     *
+     * @note Stateless and thread-safe; use instance() as a singleton.
+     */
+    class MmapResource : public std::pmr::memory_resource
+    {
+    public:
+        /// Shared instance
+        static MmapResource* instance() noexcept
+        {
+            static MmapResource resource;
+            return &resource;
+        }
+
+        /// Size of a page in bytes
+        static std::size_t page_size() noexcept
+        {
+#if MY_ALLOCATOR_HAS_MMAP
+            static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            return size;
+#else
+            return 4096;
+#endif
+        }
+
+        /// Whether allocations are whole anonymous pages
+        static constexpr bool page_backed = MY_ALLOCATOR_HAS_MMAP != 0;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+#if MY_ALLOCATOR_HAS_MMAP
+            if (alignment > page_size())
+                throw std::bad_alloc{};
+
+            void* p = ::mmap(nullptr, round_up(bytes), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (p == MAP_FAILED)
+                throw std::bad_alloc{};
+
+            return p;
+#else
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+#endif
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+#if MY_ALLOCATOR_HAS_MMAP
+            (void)alignment;
+            ::munmap(p, round_up(bytes));
+#else
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+#endif
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return dynamic_cast<const MmapResource*>(&other) != nullptr;
+        }
+
+    private:
+        static std::size_t round_up(std::size_t bytes) noexcept
+        {
+            const std::size_t page = page_size();
+            return (bytes + page - 1) & ~(page - 1);
+        }
+    };
+}
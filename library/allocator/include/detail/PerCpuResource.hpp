@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "Arena.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Lock-free per-CPU bump allocation on top of an Arena
+     *
+     * Keeps one CPU-local chunk per processor. A request picks the
+     * chunk of the CPU it runs on (sched_getcpu()) and bumps its cursor
+     * with a compare-and-swap, so threads running on different CPUs
+     * never contend, and a thread migrating mid-allocation merely
+     * retries. Memory overhead therefore scales with the number of
+     * CPUs rather than the number of threads.
+     *
+     * Chunks are carved from the arena under a mutex, which is taken
+     * only when a chunk is exhausted and for requests larger than a
+     * quarter of ChunkSize or aligned stricter than a cache line
+     * (served by the arena directly). Chunks are
+     * never released before the arena, so a stale chunk pointer stays
+     * valid and cannot cause ABA problems.
+     *
+     * Allocation is monotonic: only requests served by the arena
+     * directly are released individually.
+     *
+     * @tparam ChunkSize Size of one CPU-local chunk in bytes
+     *
+     * @note Thread-safe
+     * @note The arena must outlive the resource
+     */
+    template<std::size_t ChunkSize>
+    class PerCpuResource
+    {
+        static_assert(ChunkSize >= 256, "chunk is too small");
+
+        /// CPU-local bump region, placed at the start of its memory
+        struct Chunk
+        {
+            std::atomic<std::uintptr_t> cur;
+            std::uintptr_t end;
+        };
+
+        /// Per-CPU slot, padded to avoid false sharing between CPUs
+        struct alignas(64) Slot
+        {
+            std::atomic<Chunk*> chunk{nullptr};
+        };
+
+    public:
+        /// Largest request served from CPU-local chunks
+        static constexpr std::size_t max_chunk_request = ChunkSize / 4;
+
+        /// trim() trims the arena itself, under the arena lock
+        static constexpr bool trims_arena = true;
+
+        /**
+         * @brief Constructs the resource with one slot per CPU
+         *
+         * No memory is reserved until the first allocation on a CPU.
+         *
+         * @param arena Arena the chunks are carved from
+         */
+        explicit PerCpuResource(Arena& arena)
+                : arena_(arena),
+                  slot_count_((std::max)(std::thread::hardware_concurrency(), 1u)),
+                  slots_(std::make_unique<Slot[]>(slot_count_))
+        {}
+
+        PerCpuResource(const PerCpuResource&) = delete;
+        PerCpuResource& operator=(const PerCpuResource&) = delete;
+
+        /**
+         * @brief Allocates memory from the current CPU's chunk
+         *
+         * @param size Requested size in bytes
+         * @param alignment Requested alignment (power of two)
+         *
+         * @return Pointer to aligned memory
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            if (size > max_chunk_request || alignment > Arena::cache_line) [[unlikely]]
+            {
+                std::lock_guard lock(mutex_);
+                return arena_.allocate_bytes(size, alignment);
+            }
+
+            Slot& slot = slots_[current_cpu() % slot_count_];
+
+            for (;;)
+            {
+                Chunk* c = slot.chunk.load(std::memory_order_acquire);
+
+                if (c)
+                {
+                    std::uintptr_t cur = c->cur.load(std::memory_order_relaxed);
+
+                    for (;;)
+                    {
+                        const std::uintptr_t aligned = (cur + alignment - 1) & ~(alignment - 1);
+
+                        if (aligned > c->end || size > c->end - aligned)
+                            break;
+
+                        if (c->cur.compare_exchange_weak(cur, aligned + size,
+                                                         std::memory_order_relaxed))
+                            return reinterpret_cast<void*>(aligned);
+                    }
+                }
+
+                refill(slot, c);
+            }
+        }
+
+        /**
+         * @brief Releases memory served by the arena directly
+         *
+         * Memory from CPU-local chunks is not reclaimed.
+         */
+        void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+        {
+            if (size > max_chunk_request || alignment > Arena::cache_line)
+            {
+                std::lock_guard lock(mutex_);
+                arena_.deallocate_bytes(ptr, size);
+            }
+        }
+
+        /**
+         * @brief Trims the arena while no other thread can use it
+         *
+         * CPU-local chunks are never released, so only memory outside
+         * them is affected (see Arena::trim()).
+         *
+         * @return Number of bytes released or handed back to the OS
+         */
+        std::size_t trim() noexcept
+        {
+            std::lock_guard lock(mutex_);
+            return arena_.trim();
+        }
+
+        /// Number of per-CPU slots
+        [[nodiscard]] std::size_t slot_count() const noexcept
+        {
+            return slot_count_;
+        }
+
+    private:
+        /// Index of the CPU the calling thread runs on (0 if unknown)
+        static std::size_t current_cpu() noexcept
+        {
+#if defined(__linux__)
+            const int cpu = ::sched_getcpu();
+            return cpu < 0 ? 0 : static_cast<std::size_t>(cpu);
+#else
+            return 0;
+#endif
+        }
+
+        /**
+         * @brief Installs a fresh chunk unless another thread already did
+         *
+         * @param slot Slot whose chunk is exhausted
+         * @param seen Chunk observed as exhausted
+         */
+        void refill(Slot& slot, Chunk* seen)
+        {
+            std::lock_guard lock(mutex_);
+
+            if (slot.chunk.load(std::memory_order_relaxed) != seen)
+                return;
+
+            void* raw = arena_.allocate_bytes(ChunkSize, alignof(std::max_align_t));
+            const auto base = reinterpret_cast<std::uintptr_t>(raw);
+
+            auto* c = ::new (raw) Chunk{{base + sizeof(Chunk)}, base + ChunkSize};
+            slot.chunk.store(c, std::memory_order_release);
+        }
+
+        /// Arena providing chunks (guarded by mutex_)
+        Arena& arena_;
+
+        /// Serializes arena access
+        std::mutex mutex_;
+
+        /// Number of slots (CPUs)
+        std::size_t slot_count_;
+
+        /// One slot per CPU
+        std::unique_ptr<Slot[]> slots_;
+    };
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+
+#include "Arena.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Cross-thread deallocation through an MPSC remote-free queue
+     *
+     * Wraps a reusing resource (pool, buddy, TLSF, slab) owned by one
+     * thread: the thread that constructed it. Deallocations from the
+     * owning thread go straight to the inner resource. A foreign
+     * thread instead pushes the freed chunk onto a lock-free
+     * multi-producer stack, linking it through the chunk's own memory;
+     * the owning thread drains the stack into the inner resource's
+     * free lists on its next allocation.
+     *
+     * Every request is rounded up to hold the queue link, so chunk size
+     * and alignment can be recovered when the queue is drained.
+     *
+     * @tparam Inner Wrapped resource type
+     *
+     * @note allocate() must only be called by the owning thread;
+     *       deallocate() may be called by any thread
+     */
+    template<typename Inner>
+    class RemoteFreeResource
+    {
+        /// Chunk freed by a foreign thread, linked through its own storage
+        struct RemoteFree
+        {
+            RemoteFree* next;
+            std::size_t size;
+            std::size_t alignment;
+        };
+
+    public:
+        /**
+         * @brief Constructs the wrapper; the calling thread becomes the owner
+         *
+         * @param arena Arena passed to the inner resource
+         */
+        explicit RemoteFreeResource(Arena& arena)
+                : inner_(arena),
+                  owner_(std::this_thread::get_id())
+        {}
+
+        RemoteFreeResource(const RemoteFreeResource&) = delete;
+        RemoteFreeResource& operator=(const RemoteFreeResource&) = delete;
+
+        /**
+         * @brief Drains remote frees, then allocates from the inner resource
+         *
+         * @param size Requested size in bytes
+         * @param alignment Requested alignment (power of two)
+         *
+         * @return Pointer to aligned memory
+         */
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            if (remote_.load(std::memory_order_relaxed)) [[unlikely]]
+                drain();
+
+            return inner_.allocate(chunk_size(size), chunk_alignment(alignment));
+        }
+
+        /**
+         * @brief Non-throwing allocate(), if the inner resource has one
+         */
+        void* try_allocate(std::size_t size, std::size_t alignment) noexcept
+            requires requires (Inner& r, std::size_t n) { r.try_allocate(n, n); }
+        {
+            if (remote_.load(std::memory_order_relaxed)) [[unlikely]]
+                drain();
+
+            return inner_.try_allocate(chunk_size(size), chunk_alignment(alignment));
+        }
+
+        /**
+         * @brief Frees memory directly or through the remote-free queue
+         *
+         * @param ptr Pointer previously returned by allocate()
+         * @param size Size passed to allocate()
+         * @param alignment Alignment passed to allocate()
+         */
+        void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+        {
+            if (std::this_thread::get_id() == owner_) [[likely]]
+            {
+                inner_.deallocate(ptr, chunk_size(size), chunk_alignment(alignment));
+                return;
+            }
+
+            auto* node = ::new (ptr) RemoteFree{
+                    remote_.load(std::memory_order_relaxed),
+                    chunk_size(size),
+                    chunk_alignment(alignment)};
+
+            while (!remote_.compare_exchange_weak(node->next, node,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed))
+            {}
+
+            remote_frees_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Drains remote frees, then trims the inner resource
+         *
+         * @note Must be called by the owning thread
+         */
+        std::size_t trim() noexcept
+            requires requires (Inner& r) { r.trim(); }
+        {
+            drain();
+            return inner_.trim();
+        }
+
+        /// Wrapped resource (e.g. for its statistics)
+        [[nodiscard]] const Inner& inner() const noexcept
+        {
+            return inner_;
+        }
+
+        /// Number of deallocations received from foreign threads
+        [[nodiscard]] std::size_t remote_frees() const noexcept
+        {
+            return remote_frees_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        /// Hands every queued chunk back to the inner resource
+        void drain() noexcept
+        {
+            RemoteFree* node = remote_.exchange(nullptr, std::memory_order_acquire);
+
+            while (node)
+            {
+                RemoteFree* next = node->next;
+                inner_.deallocate(node, node->size, node->alignment);
+                node = next;
+            }
+        }
+
+        static constexpr std::size_t chunk_size(std::size_t size) noexcept
+        {
+            return (std::max)(size, sizeof(RemoteFree));
+        }
+
+        static constexpr std::size_t chunk_alignment(std::size_t alignment) noexcept
+        {
+            return (std::max)(alignment, alignof(RemoteFree));
+        }
+
+        /// Wrapped resource, used by the owning thread only
+        Inner inner_;
+
+        /// Thread allowed to allocate and to free directly
+        std::thread::id owner_;
+
+        /// Head of the remote-free stack, on its own cache line
+        alignas(64) std::atomic<RemoteFree*> remote_{nullptr};
+
+        std::atomic<std::size_t> remote_frees_{0};
+    };
+}
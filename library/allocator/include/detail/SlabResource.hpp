@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "Arena.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Bitmap slab memory resource on top of an Arena
+     *
+     * Each slab is one arena allocation holding a small header followed
+     * by SlotsPerSlab equally sized slots. Slot occupancy is tracked by a
+     * bitmap in the header (set bit = slot in use): allocation finds the
+     * first clear bit with a count-trailing-ones scan over 64-bit words,
+     * deallocation clears the bit again.
+     *
+     * Slabs are kept sorted by address and allocation always prefers the
+     * lowest slab with a free slot, so reuse stays compact and recently
+     * freed low addresses are handed out first.
+     *
+     * Slot size and alignment are fixed by the first allocation. Requests
+     * that do not fit into a slot are served by the arena directly.
+     *
+     * @tparam SlotsPerSlab Number of slots per slab (multiple of 64)
+     *
+     * @note This class is not thread-safe
+     * @note The arena must outlive the resource
+     */
+    template<std::size_t SlotsPerSlab>
+    class SlabResource
+    {
+        static_assert(SlotsPerSlab > 0 && SlotsPerSlab % 64 == 0,
+                      "slots per slab must be a positive multiple of 64");
+
+        static constexpr std::size_t Words = SlotsPerSlab / 64;
+
+        /// Slab header, followed by the slot storage
+        struct Slab
+        {
+            std::byte* slots;
+            std::size_t used;
+            std::array<std::uint64_t, Words> bitmap;
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty resource
+         *
+         * No slab is reserved until the first allocation.
+         *
+         * @param arena Arena slabs are carved from
+         */
+        explicit SlabResource(Arena& arena) noexcept
+                : arena_(arena)
+        {}
+
+        SlabResource(const SlabResource&) = delete;
+        SlabResource& operator=(const SlabResource&) = delete;
+
+        /**
+         * @brief Allocates one slot
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to a free slot
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            if (slot_size_ == 0)
+                set_geometry(size, alignment);
+
+            if (!is_slot_request(size, alignment))
+                return arena_.allocate_bytes(size, alignment);
+
+            if (first_free_ == slabs_.size())
+                add_slab();
+
+            Slab* slab = slabs_[first_free_];
+
+            std::size_t w = 0;
+            while (slab->bitmap[w] == ~std::uint64_t{0})
+                ++w;
+
+            const auto bit = static_cast<std::size_t>(std::countr_one(slab->bitmap[w]));
+            slab->bitmap[w] |= std::uint64_t{1} << bit;
+
+            if (++slab->used == SlotsPerSlab)
+            {
+                while (first_free_ < slabs_.size() &&
+                       slabs_[first_free_]->used == SlotsPerSlab)
+                    ++first_free_;
+            }
+
+            return slab->slots + (w * 64 + bit) * slot_size_;
+        }
+
+        /**
+         * @brief Releases a slot by clearing its bit
+         *
+         * @param ptr Pointer previously returned by allocate()
+         * @param size Size passed to allocate()
+         * @param alignment Alignment passed to allocate()
+         */
+        void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+        {
+            if (!is_slot_request(size, alignment))
+            {
+                arena_.deallocate_bytes(ptr, size);
+                return;
+            }
+
+            auto* p = static_cast<std::byte*>(ptr);
+
+            auto it = std::upper_bound(
+                    slabs_.begin(), slabs_.end(), p,
+                    [](std::byte* q, const Slab* s) { return q < s->slots; }) - 1;
+
+            Slab* slab = *it;
+            const auto index = static_cast<std::size_t>(p - slab->slots) / slot_size_;
+
+            slab->bitmap[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+            --slab->used;
+
+            first_free_ = (std::min)(first_free_, static_cast<std::size_t>(it - slabs_.begin()));
+        }
+
+        /**
+         * @brief Returns the memory of empty slabs
+         *
+         * Empty slabs allocated above the arena's large threshold are
+         * released and forgotten. The slots of smaller empty slabs are
+         * handed back to the OS when the arena is page-backed (see
+         * Arena::discard()).
+         *
+         * @return Number of bytes released or handed back to the OS
+         */
+        std::size_t trim() noexcept
+        {
+            const std::size_t bytes = slab_bytes();
+            std::size_t released = 0;
+
+            std::erase_if(slabs_, [&](Slab* slab) {
+                if (slab->used)
+                    return false;
+
+                if (bytes > arena_.large_threshold())
+                {
+                    arena_.deallocate_bytes(slab, bytes);
+                    released += bytes;
+                    return true;
+                }
+
+                released += arena_.discard(slab->slots, slab->slots + slot_size_ * SlotsPerSlab);
+                return false;
+            });
+
+            first_free_ = 0;
+            while (first_free_ < slabs_.size() && slabs_[first_free_]->used == SlotsPerSlab)
+                ++first_free_;
+
+            return released;
+        }
+
+        /// Number of slots currently in use
+        [[nodiscard]] std::size_t used_slots() const noexcept
+        {
+            std::size_t used = 0;
+            for (const Slab* s : slabs_)
+                used += s->used;
+            return used;
+        }
+
+        /// Total number of slots in all slabs
+        [[nodiscard]] std::size_t capacity_slots() const noexcept
+        {
+            return slabs_.size() * SlotsPerSlab;
+        }
+
+    private:
+        /// Whether the request is served by slab slots
+        bool is_slot_request(std::size_t size, std::size_t alignment) const noexcept
+        {
+            return size <= slot_size_ && alignment <= slot_align_;
+        }
+
+        /// Fixes slot size and alignment from the first request
+        void set_geometry(std::size_t size, std::size_t alignment) noexcept
+        {
+            slot_align_ = alignment;
+            slot_size_ = (size + alignment - 1) & ~(alignment - 1);
+
+            if (slot_size_ == 0)
+                slot_size_ = alignment;
+        }
+
+        /// Alignment of a slab allocation
+        std::size_t slab_align() const noexcept
+        {
+            return (std::max)(slot_align_, alignof(Slab));
+        }
+
+        /// Header bytes in front of the slots, keeping them aligned
+        std::size_t slab_header() const noexcept
+        {
+            return (sizeof(Slab) + slab_align() - 1) & ~(slab_align() - 1);
+        }
+
+        /// Size of a slab allocation
+        std::size_t slab_bytes() const noexcept
+        {
+            return slab_header() + slot_size_ * SlotsPerSlab;
+        }
+
+        /**
+         * @brief Reserves a new slab from the arena
+         *
+         * Header and slots are obtained with one request.
+         */
+        void add_slab()
+        {
+            auto* raw = static_cast<std::byte*>(
+                    arena_.allocate_bytes(slab_bytes(), slab_align()));
+
+            Slab* slab = ::new (raw) Slab{raw + slab_header(), 0, {}};
+
+            auto pos = std::upper_bound(
+                    slabs_.begin(), slabs_.end(), slab->slots,
+                    [](std::byte* q, const Slab* s) { return q < s->slots; });
+
+            first_free_ = static_cast<std::size_t>(pos - slabs_.begin());
+            slabs_.insert(pos, slab);
+        }
+
+        /// Arena providing slab memory
+        Arena& arena_;
+
+        /// Slabs sorted by address
+        std::vector<Slab*> slabs_;
+
+        /// Index of the lowest slab with a free slot
+        std::size_t first_free_ = 0;
+
+        /// Size of one slot in bytes (0 until the first allocation)
+        std::size_t slot_size_ = 0;
+
+        /// Alignment of every slot
+        std::size_t slot_align_ = 0;
+    };
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include "Arena.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Bounded pool of equally sized slots carved from an Arena
+     *
+     * The pool owns at most Slots slots. Slot size and alignment are
+     * fixed by the first allocation (typically the rebound node type of
+     * a container), and the whole region is reserved from the arena at
+     * that moment, so the pool never exceeds its hard memory cap.
+     *
+     * Freed slots are kept in an intrusive singly-linked free list
+     * and reused in O(1).
+     *
+     * @tparam Slots Maximum number of slots
+     *
+     * @note This class is not thread-safe
+     * @note The arena must outlive the pool
+     */
+    template<std::size_t Slots>
+    class SlotPool
+    {
+        static_assert(Slots > 0, "pool must contain at least one slot");
+
+        /// Free slot, linked through its own storage
+        struct FreeSlot
+        {
+            FreeSlot* next;
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty pool
+         *
+         * No memory is reserved until the first allocation.
+         *
+         * @param arena Arena the slot region is carved from
+         */
+        explicit SlotPool(Arena& arena) noexcept
+                : arena_(arena)
+        {}
+
+        SlotPool(const SlotPool&) = delete;
+        SlotPool& operator=(const SlotPool&) = delete;
+
+        /**
+         * @brief Allocates one slot
+         *
+         * @param size Requested size in bytes (must fit into a slot)
+         * @param alignment Requested alignment (must not exceed slot alignment)
+         *
+         * @return Pointer to a free slot
+         *
+         * @throws std::bad_alloc if all slots are in use or the request
+         *         does not fit into a slot
+         */
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            if (slot_size_ == 0)
+                reserve(size, alignment);
+
+            if (void* ptr = take(size, alignment))
+                return ptr;
+
+            throw std::bad_alloc{};
+        }
+
+        /**
+         * @brief Allocates one slot without throwing
+         *
+         * @param size Requested size in bytes
+         * @param alignment Requested alignment
+         *
+         * @return Pointer to a free slot, or nullptr if all slots are in
+         *         use, the request does not fit into a slot or the slot
+         *         region cannot be reserved
+         */
+        void* try_allocate(std::size_t size, std::size_t alignment) noexcept
+        {
+            if (slot_size_ == 0)
+            {
+                try {
+                    reserve(size, alignment);
+                } catch (...) {
+                    return nullptr;
+                }
+            }
+
+            return take(size, alignment);
+        }
+
+        /**
+         * @brief Returns a slot to the pool
+         *
+         * @param ptr Pointer previously returned by allocate()
+         */
+        void deallocate(void* ptr, std::size_t, std::size_t) noexcept
+        {
+            free_ = ::new (ptr) FreeSlot{free_};
+        }
+
+    private:
+        /**
+         * @brief Pops a free slot or carves a never-used one
+         *
+         * @return Pointer to a slot, or nullptr if none is available or
+         *         the request does not fit into a slot
+         */
+        void* take(std::size_t size, std::size_t alignment) noexcept
+        {
+            if (size > slot_size_ || alignment > slot_align_)
+                return nullptr;
+
+            if (free_)
+            {
+                FreeSlot* slot = free_;
+                free_ = slot->next;
+                return slot;
+            }
+
+            if (next_ == end_)
+                return nullptr;
+
+            void* ptr = next_;
+            next_ += slot_size_;
+            return ptr;
+        }
+
+        /**
+         * @brief Fixes slot geometry and reserves the slot region
+         *
+         * @param size Size of the first request in bytes
+         * @param alignment Alignment of the first request
+         */
+        void reserve(std::size_t size, std::size_t alignment)
+        {
+            slot_align_ = (std::max)(alignment, alignof(FreeSlot));
+
+            const std::size_t raw = (std::max)(size, sizeof(FreeSlot));
+            const std::size_t slot = (raw + slot_align_ - 1) & ~(slot_align_ - 1);
+
+            next_ = static_cast<std::byte*>(
+                    arena_.allocate_bytes(slot * Slots, slot_align_));
+            end_ = next_ + slot * Slots;
+
+            slot_size_ = slot;
+        }
+
+        /// Arena providing the slot region
+        Arena& arena_;
+
+        /// Head of the free list
+        FreeSlot* free_ = nullptr;
+
+        /// First never-used slot
+        std::byte* next_ = nullptr;
+
+        /// End of the slot region
+        std::byte* end_ = nullptr;
+
+        /// Size of one slot in bytes (0 until the first allocation)
+        std::size_t slot_size_ = 0;
+
+        /// Alignment of every slot
+        std::size_t slot_align_ = 0;
+    };
+}
@@ -0,0 +1,426 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "Arena.hpp"
+
+namespace my_allocator::detail
+{
+    /**
+     * @brief Two-level segregated fit (TLSF) memory resource on an Arena
+     *
+     * Memory is managed in pools of PoolSize bytes obtained from the
+     * arena. Free blocks are indexed by a two-level size class: the first
+     * level is the power of two of the block size, the second level splits
+     * each power-of-two range into SlCount linear classes. Non-empty
+     * classes are tracked in bitmaps, so a suitable block is found with
+     * two find-first-set operations.
+     *
+     * Blocks carry boundary tags, and freed blocks are immediately
+     * coalesced with free physical neighbours. Allocation and
+     * deallocation are O(1).
+     *
+     * Requests aligned stricter than the 16-byte block granularity
+     * (up to a cache line) split off a leading free block to reach
+     * their alignment. Requests larger than a quarter of PoolSize or
+     * aligned stricter than a cache line are served by the arena
+     * directly.
+     *
+     * @tparam PoolSize Size of one TLSF pool (power of two)
+     *
+     * @note This class is not thread-safe
+     * @note The arena must outlive the resource
+     */
+    template<std::size_t PoolSize>
+    class TlsfResource
+    {
+        /**
+         * @brief Block header (boundary tag)
+         *
+         * size holds the payload size; its low bits store the
+         * FreeBit and PrevFreeBit flags. prev_phys is valid only
+         * while the previous physical block is free. Free blocks
+         * reuse their payload for the free-list links.
+         */
+        struct Block
+        {
+            Block*      prev_phys;
+            std::size_t size;
+            Block*      next_free;
+            Block*      prev_free;
+        };
+
+        /// Header bytes preceding every payload
+        static constexpr std::size_t Header = offsetof(Block, next_free);
+
+        /// Payload alignment and size granularity
+        static constexpr std::size_t Align = 16;
+
+        /// Smallest payload (must hold free-list links)
+        static constexpr std::size_t MinPayload = sizeof(Block) - Header;
+
+        static constexpr std::size_t SlLog2  = 4;
+        static constexpr std::size_t SlCount = std::size_t{1} << SlLog2;
+        static constexpr std::size_t FlShift = SlLog2 + std::countr_zero(Align);
+        static constexpr std::size_t Small   = std::size_t{1} << FlShift;
+
+        static_assert(std::has_single_bit(PoolSize), "pool size must be power of two");
+        static_assert(PoolSize >= 4 * Small, "pool size too small");
+        static_assert(Header == Align, "header must preserve payload alignment");
+
+        /// Number of first-level classes
+        static constexpr std::size_t FlCount =
+                std::countr_zero(PoolSize) - FlShift + 1;
+
+        /// Payload of the free block spanning a whole pool
+        static constexpr std::size_t PoolPayload = PoolSize - 2 * Header;
+
+        /// Largest request served from pools
+        static constexpr std::size_t MaxRequest = PoolSize / 4;
+
+        /// Strictest alignment served from pools
+        static constexpr std::size_t MaxAlign = Arena::cache_line;
+
+        static constexpr std::size_t FreeBit     = 1;
+        static constexpr std::size_t PrevFreeBit = 2;
+        static constexpr std::size_t FlagMask    = FreeBit | PrevFreeBit;
+
+    public:
+        /**
+         * @brief Constructs an empty resource
+         *
+         * No pool is reserved until the first allocation.
+         *
+         * @param arena Arena pools are carved from
+         */
+        explicit TlsfResource(Arena& arena) noexcept
+                : arena_(arena)
+        {}
+
+        TlsfResource(const TlsfResource&) = delete;
+        TlsfResource& operator=(const TlsfResource&) = delete;
+
+        /**
+         * @brief Allocates a block of at least size bytes
+         *
+         * @param size Number of bytes to allocate
+         * @param alignment Required alignment (power of two)
+         *
+         * @return Pointer to aligned memory block
+         *
+         * @throws std::bad_alloc if memory allocation fails
+         */
+        void* allocate(std::size_t size, std::size_t alignment)
+        {
+            if (!is_tlsf_request(size, alignment))
+                return arena_.allocate_bytes(size, alignment);
+
+            const std::size_t payload = adjust(size);
+
+            // Over-aligned requests need room for a leading free block
+            const std::size_t search = alignment > Align
+                    ? payload + alignment + Header + MinPayload
+                    : payload;
+
+            Block* block = find_free(search);
+            if (!block)
+            {
+                add_pool();
+                block = find_free(search);
+            }
+
+            remove_free(block);
+
+            if (alignment > Align)
+                block = split_leading(block, alignment);
+
+            if (size_of(block) - payload >= Header + MinPayload)
+            {
+                Block* rest = at(payload_of(block) + payload);
+                rest->size = (size_of(block) - payload - Header) | FreeBit;
+                set_size(block, payload);
+
+                link_next(rest);
+                insert_free(rest);
+            }
+
+            block->size &= ~FreeBit;
+            next_phys(block)->size &= ~PrevFreeBit;
+
+            return payload_of(block);
+        }
+
+        /**
+         * @brief Frees a block and coalesces it with free neighbours
+         *
+         * @param ptr Pointer previously returned by allocate()
+         * @param size Size passed to allocate()
+         * @param alignment Alignment passed to allocate()
+         */
+        void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+        {
+            if (!is_tlsf_request(size, alignment))
+            {
+                arena_.deallocate_bytes(ptr, size);
+                return;
+            }
+
+            Block* block = at(static_cast<std::byte*>(ptr) - Header);
+
+            if (block->size & PrevFreeBit)
+            {
+                Block* prev = block->prev_phys;
+                remove_free(prev);
+                set_size(prev, size_of(prev) + Header + size_of(block));
+                block = prev;
+            }
+
+            Block* next = next_phys(block);
+            if (next->size & FreeBit)
+            {
+                remove_free(next);
+                set_size(block, size_of(block) + Header + size_of(next));
+            }
+
+            block->size |= FreeBit;
+            link_next(block);
+            insert_free(block);
+        }
+
+        /**
+         * @brief Returns the memory of pools that are one free block
+         *
+         * Such pools are released and forgotten when they were
+         * allocated above the arena's large threshold. Otherwise their
+         * pages are handed back to the OS when the arena is page-backed
+         * (see Arena::discard()).
+         *
+         * @return Number of bytes released or handed back to the OS
+         */
+        std::size_t trim() noexcept
+        {
+            std::size_t fl, sl;
+            mapping_insert(PoolPayload, fl, sl);
+
+            std::size_t released = 0;
+            Block* next;
+
+            for (Block* b = free_[fl][sl]; b; b = next)
+            {
+                next = b->next_free;
+
+                if (size_of(b) != PoolPayload)
+                    continue;
+
+                if (PoolSize > arena_.large_threshold())
+                {
+                    remove_free(b);
+                    arena_.deallocate_bytes(b, PoolSize);
+                    released += PoolSize;
+                }
+                else
+                {
+                    released += arena_.discard(payload_of(b) + MinPayload, payload_of(b) + PoolPayload);
+                }
+            }
+
+            return released;
+        }
+
+    private:
+        /// Whether the request is served by TLSF pools
+        static bool is_tlsf_request(std::size_t size, std::size_t alignment) noexcept
+        {
+            return size <= MaxRequest && alignment <= MaxAlign;
+        }
+
+        /**
+         * @brief Aligns the payload of a block taken from a free list
+         *
+         * The bytes in front of the first suitably aligned payload
+         * become a free block of their own.
+         *
+         * @param block Block removed from its free list
+         * @param alignment Required payload alignment (> Align)
+         *
+         * @return Block whose payload is aligned
+         */
+        Block* split_leading(Block* block, std::size_t alignment) noexcept
+        {
+            const auto payload = reinterpret_cast<std::uintptr_t>(payload_of(block));
+            auto aligned = (payload + alignment - 1) & ~(alignment - 1);
+
+            if (aligned == payload)
+                return block;
+
+            while (aligned - payload < Header + MinPayload)
+                aligned += alignment;
+
+            const std::size_t gap = aligned - payload;
+
+            Block* rest = at(reinterpret_cast<std::byte*>(aligned) - Header);
+            rest->size = (size_of(block) - gap) | FreeBit;
+
+            set_size(block, gap - Header);
+            link_next(block);
+            insert_free(block);
+
+            return rest;
+        }
+
+        /// Rounds a request to a valid payload size
+        static std::size_t adjust(std::size_t size) noexcept
+        {
+            const std::size_t rounded = (size + Align - 1) & ~(Align - 1);
+            return rounded < MinPayload ? MinPayload : rounded;
+        }
+
+        static Block* at(std::byte* p) noexcept
+        {
+            return reinterpret_cast<Block*>(p);
+        }
+
+        static std::size_t size_of(const Block* b) noexcept
+        {
+            return b->size & ~FlagMask;
+        }
+
+        static void set_size(Block* b, std::size_t size) noexcept
+        {
+            b->size = size | (b->size & FlagMask);
+        }
+
+        static std::byte* payload_of(Block* b) noexcept
+        {
+            return reinterpret_cast<std::byte*>(b) + Header;
+        }
+
+        static Block* next_phys(Block* b) noexcept
+        {
+            return at(payload_of(b) + size_of(b));
+        }
+
+        /// Marks block as free in its physical successor
+        static void link_next(Block* b) noexcept
+        {
+            Block* next = next_phys(b);
+            next->prev_phys = b;
+            next->size |= PrevFreeBit;
+        }
+
+        /// Computes the size class a block of given size belongs to
+        static void mapping_insert(std::size_t size, std::size_t& fl, std::size_t& sl) noexcept
+        {
+            if (size < Small)
+            {
+                fl = 0;
+                sl = size / (Small / SlCount);
+            }
+            else
+            {
+                const std::size_t log2 = std::bit_width(size) - 1;
+                sl = (size >> (log2 - SlLog2)) ^ SlCount;
+                fl = log2 - (FlShift - 1);
+            }
+        }
+
+        /// Finds a free block of at least size bytes, or nullptr
+        Block* find_free(std::size_t size) noexcept
+        {
+            if (size >= Small)
+                size += (std::size_t{1} << (std::bit_width(size) - 1 - SlLog2)) - 1;
+
+            std::size_t fl, sl;
+            mapping_insert(size, fl, sl);
+
+            std::uint32_t sl_map = sl_bitmap_[fl] & (~std::uint32_t{0} << sl);
+            if (!sl_map)
+            {
+                const std::uint32_t fl_map =
+                        fl + 1 < FlCount ? fl_bitmap_ & (~std::uint32_t{0} << (fl + 1)) : 0;
+
+                if (!fl_map)
+                    return nullptr;
+
+                fl = std::countr_zero(fl_map);
+                sl_map = sl_bitmap_[fl];
+            }
+
+            sl = std::countr_zero(sl_map);
+            return free_[fl][sl];
+        }
+
+        void insert_free(Block* b) noexcept
+        {
+            std::size_t fl, sl;
+            mapping_insert(size_of(b), fl, sl);
+
+            b->prev_free = nullptr;
+            b->next_free = free_[fl][sl];
+
+            if (b->next_free)
+                b->next_free->prev_free = b;
+
+            free_[fl][sl] = b;
+            fl_bitmap_ |= std::uint32_t{1} << fl;
+            sl_bitmap_[fl] |= std::uint32_t{1} << sl;
+        }
+
+        void remove_free(Block* b) noexcept
+        {
+            std::size_t fl, sl;
+            mapping_insert(size_of(b), fl, sl);
+
+            if (b->next_free)
+                b->next_free->prev_free = b->prev_free;
+
+            if (b->prev_free)
+                b->prev_free->next_free = b->next_free;
+            else
+                free_[fl][sl] = b->next_free;
+
+            if (!free_[fl][sl])
+            {
+                sl_bitmap_[fl] &= ~(std::uint32_t{1} << sl);
+                if (!sl_bitmap_[fl])
+                    fl_bitmap_ &= ~(std::uint32_t{1} << fl);
+            }
+        }
+
+        /**
+         * @brief Reserves a new pool from the arena
+         *
+         * The pool holds one free block followed by a zero-sized
+         * used sentinel that stops coalescing at the pool end.
+         */
+        void add_pool()
+        {
+            auto* base = static_cast<std::byte*>(
+                    arena_.allocate_bytes(PoolSize, Align));
+
+            Block* block = at(base);
+            block->size = PoolPayload | FreeBit;
+
+            Block* sentinel = next_phys(block);
+            sentinel->size = 0;
+            link_next(block);
+
+            insert_free(block);
+        }
+
+        /// Arena providing pool memory
+        Arena& arena_;
+
+        /// First-level bitmap of non-empty classes
+        std::uint32_t fl_bitmap_ = 0;
+
+        /// Second-level bitmaps of non-empty classes
+        std::array<std::uint32_t, FlCount> sl_bitmap_{};
+
+        /// Free lists indexed by [fl][sl]
+        std::array<std::array<Block*, SlCount>, FlCount> free_{};
+    };
+}
@@ -1,15 +1,79 @@
 #define BOOST_TEST_MODULE my_map_allocator_tests
 #include <boost/test/included/unit_test.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <type_traits>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <forward_list>
-
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ArenaResource.hpp"
 #include "MyMapAllocator.hpp"
 
 namespace policy = my_allocator::policy;
 
+// Counts global operator new calls, to verify heap-free paths. The
+// whole replaceable set is defined so every form pairs with its delete.
+std::atomic<std::size_t> g_operator_new_calls{0};
+
+namespace
+{
+    void* counted_alloc(std::size_t size, std::size_t align) noexcept
+    {
+        g_operator_new_calls.fetch_add(1, std::memory_order_relaxed);
+
+        if (size == 0)
+            size = 1;
+
+        if (align <= alignof(std::max_align_t))
+            return std::malloc(size);
+
+        return std::aligned_alloc(align, (size + align - 1) & ~(align - 1));
+    }
+
+    void* counted_new(std::size_t size, std::size_t align)
+    {
+        if (void* p = counted_alloc(size, align))
+            return p;
+
+        throw std::bad_alloc{};
+    }
+}
+
+void* operator new(std::size_t size) { return counted_new(size, 0); }
+void* operator new[](std::size_t size) { return counted_new(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al) { return counted_new(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return counted_new(size, static_cast<std::size_t>(al)); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return counted_alloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return counted_alloc(size, static_cast<std::size_t>(al)); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
 
 
 // ============================================================
@@ -214,3 +278,1668 @@ BOOST_AUTO_TEST_CASE(map_with_custom_allocator_expandable)
     for (int i = 0; i < 10; ++i)
         BOOST_CHECK_EQUAL(m[i], i * 10);
 }
+
+
+
+// ============================================================
+// Arena compile-time alignment fast path
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(arena_compile_time_alignment)
+{
+    my_allocator::detail::Arena arena(64);
+
+    void* a = arena.allocate_bytes<1>(3);
+    void* b = arena.allocate_bytes<16>(8);
+    void* c = arena.allocate_bytes<64>(128);
+
+    BOOST_REQUIRE(a != nullptr);
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(b) % 16 == 0);
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(c) % 64 == 0);
+
+    BOOST_CHECK_THROW(
+            arena.allocate_bytes(8, 3),
+            std::invalid_argument
+    );
+}
+
+
+
+// ============================================================
+// Pool policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(pool_reuses_deallocated_slots)
+{
+    using Alloc = MyMapAllocator<int, policy::Pool<2>>;
+    Alloc alloc;
+
+    int* a = alloc.allocate(1);
+    int* b = alloc.allocate(1);
+
+    BOOST_REQUIRE(a != b);
+    BOOST_CHECK_THROW(alloc.allocate(1), std::bad_alloc);
+
+    alloc.deallocate(a, 1);
+
+    int* c = nullptr;
+    BOOST_CHECK_NO_THROW(c = alloc.allocate(1));
+    BOOST_CHECK(c == a);
+}
+
+BOOST_AUTO_TEST_CASE(map_with_pool_runs_indefinitely)
+{
+    using Alloc =
+            MyMapAllocator<
+                    std::pair<const int, int>,
+                    policy::Pool<16>
+            >;
+
+    using Map =
+            std::map<int, int, std::less<int>, Alloc>;
+
+    Map m;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        m.emplace(i, i * 10);
+
+        if (m.size() == 16)
+            m.erase(m.begin());
+    }
+
+    BOOST_CHECK_EQUAL(m.size(), 15u);
+    BOOST_CHECK_EQUAL(m.rbegin()->second, 9990);
+}
+
+
+
+// ============================================================
+// Buddy policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(buddy_coalesces_freed_blocks)
+{
+    using Alloc = MyMapAllocator<char, policy::Buddy<1024, 32>>;
+    Alloc alloc;
+
+    char* whole = alloc.allocate(1024);
+    alloc.deallocate(whole, 1024);
+
+    char* a = alloc.allocate(32);
+    char* b = alloc.allocate(100);
+    char* c = alloc.allocate(300);
+
+    BOOST_CHECK(a == whole);
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(b) % 128 ==
+                reinterpret_cast<std::uintptr_t>(whole) % 128);
+
+    alloc.deallocate(b, 100);
+    alloc.deallocate(a, 32);
+    alloc.deallocate(c, 300);
+
+    BOOST_CHECK(alloc.allocate(1024) == whole);
+}
+
+BOOST_AUTO_TEST_CASE(map_with_buddy_reuses_memory)
+{
+    using Alloc =
+            MyMapAllocator<
+                    std::pair<const int, int>,
+                    policy::Buddy<4096, 32>
+            >;
+
+    std::map<int, int, std::less<int>, Alloc> m;
+
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int i = 0; i < 100; ++i)
+            m.emplace(i, i + round);
+
+        BOOST_CHECK_EQUAL(m.size(), 100u);
+        m.clear();
+    }
+
+    BOOST_CHECK(m.empty());
+}
+
+
+
+// ============================================================
+// TLSF policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(tlsf_reuses_and_coalesces)
+{
+    using Alloc = MyMapAllocator<char, policy::Tlsf<4096>>;
+    Alloc alloc;
+
+    char* a = alloc.allocate(40);
+    char* b = alloc.allocate(200);
+    char* c = alloc.allocate(24);
+
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(b) % 16 == 0);
+
+    alloc.deallocate(b, 200);
+    BOOST_CHECK(alloc.allocate(200) == b);
+
+    alloc.deallocate(a, 40);
+    alloc.deallocate(b, 200);
+    alloc.deallocate(c, 24);
+
+    char* big = alloc.allocate(1000);
+    BOOST_CHECK(big == a);
+}
+
+BOOST_AUTO_TEST_CASE(map_with_tlsf)
+{
+    using Alloc =
+            MyMapAllocator<
+                    std::pair<const int, int>,
+                    policy::Tlsf<4096>
+            >;
+
+    std::map<int, int, std::less<int>, Alloc> m;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        m.emplace(i, i);
+
+        if (i % 3 == 0)
+            m.erase(i / 2);
+    }
+
+    for (const auto& [key, value] : m)
+        BOOST_CHECK_EQUAL(key, value);
+}
+
+
+
+// ============================================================
+// Slab policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(slab_reuses_lowest_free_slot)
+{
+    using Alloc = MyMapAllocator<std::uint64_t, policy::Slab<64>>;
+    Alloc alloc;
+
+    std::uint64_t* slots[128];
+    for (std::size_t i = 0; i < 100; ++i)
+        slots[i] = alloc.allocate(1);
+
+    BOOST_CHECK_EQUAL(alloc.resource().used_slots(), 100u);
+    BOOST_CHECK_EQUAL(alloc.resource().capacity_slots(), 128u);
+
+    // Fill both slabs, so the freed slots are the only free ones
+    for (std::size_t i = 100; i < 128; ++i)
+        slots[i] = alloc.allocate(1);
+
+    alloc.deallocate(slots[70], 1);
+    alloc.deallocate(slots[5], 1);
+
+    BOOST_CHECK_EQUAL(alloc.resource().used_slots(), 126u);
+
+    // Each slab is its own upstream block, so their order is up to upstream
+    const auto [low, high] = std::minmax(slots[5], slots[70], std::less<>{});
+
+    BOOST_CHECK(alloc.allocate(1) == low);
+    BOOST_CHECK(alloc.allocate(1) == high);
+}
+
+
+
+// ============================================================
+// Arena large allocations
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(arena_large_allocation_keeps_current_block)
+{
+    my_allocator::detail::Arena arena(1024);
+
+    auto* a = static_cast<std::byte*>(arena.allocate_bytes<8>(16));
+    void* big = arena.allocate_bytes<64>(arena.large_threshold() + 1);
+    auto* b = static_cast<std::byte*>(arena.allocate_bytes<8>(16));
+
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(big) % 64 == 0);
+    BOOST_CHECK(b == a + 16);
+
+    arena.deallocate_bytes(big, arena.large_threshold() + 1);
+
+    void* other = arena.allocate_bytes(2 * arena.large_threshold(), 8);
+    BOOST_REQUIRE(other != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(arena_reuses_tail_of_retired_block)
+{
+    my_allocator::detail::Arena arena(1024);
+
+    auto* a = static_cast<std::byte*>(arena.allocate_bytes<8>(96));
+
+    // Does not fit into the remaining ~900 bytes: a new block is added
+    arena.allocate_bytes<8>(2000);
+
+    // The new block is exhausted; served from the old block's tail
+    auto* b = static_cast<std::byte*>(arena.allocate_bytes<8>(256));
+    auto* c = static_cast<std::byte*>(arena.allocate_bytes<8>(256));
+
+    BOOST_CHECK(b == a + 96);
+    BOOST_CHECK(c == b + 256);
+}
+
+
+
+// ============================================================
+// Upstream memory source
+// ============================================================
+
+namespace
+{
+    struct CountingResource : std::pmr::memory_resource
+    {
+        std::size_t live = 0;
+        std::size_t calls = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t align) override
+        {
+            ++calls;
+            live += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+        {
+            live -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    CountingResource counting_upstream;
+
+    std::pmr::memory_resource* get_counting_upstream() noexcept
+    {
+        return &counting_upstream;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(arena_uses_upstream_from_policy)
+{
+    using Policy = policy::WithUpstream<policy::Expandable<16>, &get_counting_upstream>;
+
+    {
+        std::map<int, int, std::less<>,
+                 MyMapAllocator<std::pair<const int, int>, Policy>> m;
+
+        for (int i = 0; i < 100; ++i)
+            m[i] = i;
+
+        BOOST_CHECK(counting_upstream.calls > 0);
+        BOOST_CHECK(counting_upstream.live > 0);
+    }
+
+    BOOST_CHECK_EQUAL(counting_upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(allocator_over_explicit_upstream)
+{
+    CountingResource upstream;
+
+    {
+        MyMapAllocator<int, policy::Expandable<8>> alloc(&upstream);
+
+        int* p = alloc.allocate(4);
+        BOOST_REQUIRE(p != nullptr);
+        BOOST_CHECK_EQUAL(upstream.calls, 1u);
+
+        alloc.allocate(1000);
+        BOOST_CHECK_EQUAL(upstream.calls, 2u);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+
+
+// ============================================================
+// pmr adapter
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(pmr_containers_over_arena_resource)
+{
+    CountingResource upstream;
+
+    {
+        my_allocator::ArenaResource<policy::Expandable<1024>> arena(&upstream);
+
+        std::pmr::map<int, std::pmr::string> m(&arena);
+        for (int i = 0; i < 100; ++i)
+            m.emplace(i, std::string(40, 'x'));
+
+        std::pmr::vector<int> v(&arena);
+        v.resize(10000);
+
+        BOOST_CHECK_EQUAL(m.size(), 100u);
+        BOOST_CHECK(m.get_allocator().resource() == &arena);
+        BOOST_CHECK(upstream.live > 0);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_arena_resource_reuses_with_policy)
+{
+    my_allocator::ArenaResource<policy::Slab<64>> slab;
+
+    {
+        std::pmr::map<int, int> m(&slab);
+        for (int i = 0; i < 50; ++i)
+            m[i] = i;
+
+        BOOST_CHECK_EQUAL(slab.resource().used_slots(), 50u);
+    }
+
+    BOOST_CHECK_EQUAL(slab.resource().used_slots(), 0u);
+}
+
+
+
+// ============================================================
+// Runtime policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(runtime_policy_enforces_configured_limit)
+{
+    using Alloc = MyMapAllocator<int, policy::Runtime>;
+    Alloc alloc(policy::Runtime::Config{.max = 4, .block_size = 64});
+
+    alloc.allocate(3);
+    alloc.allocate(1);
+
+    BOOST_CHECK_THROW(alloc.allocate(1), std::bad_alloc);
+}
+
+BOOST_AUTO_TEST_CASE(runtime_policy_grows_blocks_geometrically)
+{
+    CountingResource upstream;
+
+    {
+        MyMapAllocator<char, policy::Runtime> alloc(
+                policy::Runtime::Config{.block_size = 1024, .growth_factor = 2.0},
+                &upstream);
+
+        for (int i = 0; i < 7 * 1024; i += 512)
+            alloc.allocate(512);
+
+        // 1 KiB + 2 KiB + 4 KiB blocks
+        BOOST_CHECK_EQUAL(upstream.calls, 3u);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(map_with_runtime_policy)
+{
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Runtime>;
+
+    std::map<int, int, std::less<>, Alloc> m(Alloc(policy::Runtime::Config{.max = 100}));
+
+    for (int i = 0; i < 100; ++i)
+        m[i] = i;
+
+    BOOST_CHECK_THROW(m[100] = 100, std::bad_alloc);
+    BOOST_CHECK_EQUAL(m.size(), 100u);
+}
+
+BOOST_AUTO_TEST_CASE(wrapped_runtime_policy_keeps_config)
+{
+    CountingResource upstream;
+
+    using Wrapped = policy::Provisioned<policy::Mmap<policy::Runtime>>;
+    using Alloc = MyMapAllocator<std::pair<const int, int>, Wrapped>;
+
+    Alloc alloc(policy::Runtime::Config{.max = 100, .block_size = 1024});
+
+    std::map<int, int, std::less<>, Alloc> m(alloc);
+    for (int i = 0; i < 100; ++i)
+        m.emplace(i, i);
+
+    BOOST_CHECK_THROW(m.emplace(100, 100), std::bad_alloc);
+    BOOST_CHECK_EQUAL(m.size(), 100u);
+
+    using Counted = MyMapAllocator<int, policy::IdleTrim<policy::Runtime, 10>>;
+    Counted counted(policy::Runtime::Config{.block_size = 512}, &upstream);
+    counted.allocate(1);
+    BOOST_CHECK_EQUAL(upstream.calls, 1u);
+    BOOST_CHECK(upstream.live >= 512u && upstream.live < 1024u);
+}
+
+
+
+// ============================================================
+// Caller-provided buffer
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(map_in_stack_buffer_without_heap)
+{
+    alignas(std::max_align_t) std::byte buffer[8192];
+    CountingResource upstream;
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Expandable<>>;
+
+    std::map<int, int, std::less<>, Alloc> m(Alloc(std::span<std::byte>(buffer), &upstream));
+
+    for (int i = 0; i < 50; ++i)
+        m[i] = i;
+
+    BOOST_CHECK_EQUAL(upstream.calls, 0u);
+
+    const auto* node = reinterpret_cast<const std::byte*>(&*m.find(25));
+    BOOST_CHECK(node >= buffer && node < buffer + sizeof(buffer));
+
+    for (int i = 50; i < 1000; ++i)
+        m[i] = i;
+
+    BOOST_CHECK(upstream.calls > 0);
+}
+
+BOOST_AUTO_TEST_CASE(map_in_stack_buffer_performs_no_heap_allocation)
+{
+    alignas(std::max_align_t) std::byte buffer[8192];
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Expandable<>>;
+
+    const std::size_t before = g_operator_new_calls.load();
+
+    {
+        std::map<int, int, std::less<>, Alloc> m(
+                Alloc(std::span<std::byte>(buffer), std::pmr::null_memory_resource()));
+
+        for (int i = 0; i < 50; ++i)
+            m[i] = i;
+
+        BOOST_CHECK_EQUAL(m.at(49), 49);
+    }
+
+    BOOST_CHECK_EQUAL(g_operator_new_calls.load(), before);
+
+    // A pool resource lives in the buffer as well
+    {
+        using PoolAlloc = MyMapAllocator<std::uint64_t, policy::Pool<64>>;
+        PoolAlloc pool(std::span<std::byte>(buffer), std::pmr::null_memory_resource());
+        pool.deallocate(pool.allocate(1), 1);
+    }
+
+    BOOST_CHECK_EQUAL(g_operator_new_calls.load(), before);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_serves_requests_larger_than_half_of_it)
+{
+    alignas(std::max_align_t) std::byte buffer[16384];
+
+    MyMapAllocator<int, policy::Expandable<>> alloc(
+            std::span<std::byte>(buffer), std::pmr::null_memory_resource());
+
+    int* p = alloc.allocate(2500);
+    BOOST_CHECK(reinterpret_cast<std::byte*>(p) >= buffer &&
+                reinterpret_cast<std::byte*>(p + 2500) <= buffer + sizeof(buffer));
+
+    alignas(std::max_align_t) std::byte big[65536];
+
+    std::vector<int, MyMapAllocator<int, policy::Expandable<>>> v(
+            MyMapAllocator<int, policy::Expandable<>>(std::span<std::byte>(big),
+                                                      std::pmr::null_memory_resource()));
+
+    // Monotonic growth to capacity 4096 takes half of the buffer
+    for (int i = 0; i < 4096; ++i)
+        v.push_back(i);
+
+    BOOST_CHECK_EQUAL(v.back(), 4095);
+    BOOST_CHECK(reinterpret_cast<std::byte*>(v.data()) >= big &&
+                reinterpret_cast<std::byte*>(v.data() + 4096) <= big + sizeof(big));
+}
+
+BOOST_AUTO_TEST_CASE(buffer_without_fallback_throws_when_exhausted)
+{
+    alignas(std::max_align_t) std::byte buffer[256];
+
+    MyMapAllocator<std::uint64_t, policy::Expandable<>> alloc(
+            std::span<std::byte>(buffer), std::pmr::null_memory_resource());
+
+    alloc.allocate(32);
+
+    BOOST_CHECK_THROW(alloc.allocate(1), std::bad_alloc);
+}
+
+
+
+// ============================================================
+// Fixed policy embedded storage
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(fixed_map_nodes_live_in_control_block)
+{
+    CountingResource upstream;
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Fixed<64>>;
+
+    {
+        Alloc alloc(&upstream);
+        std::map<int, int, std::less<>, Alloc> m(alloc);
+
+        for (int i = 0; i < 64; ++i)
+            m[i] = i;
+
+        // All nodes fit into the embedded first block
+        BOOST_CHECK_EQUAL(upstream.calls, 0u);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+
+
+// ============================================================
+// Shared arena handle
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(arena_handle_shared_across_types_and_policies)
+{
+    CountingResource upstream;
+
+    {
+        my_allocator::ArenaHandle arena(4096, &upstream);
+
+        using MapAlloc  = MyMapAllocator<std::pair<const int, int>, policy::Expandable<>>;
+        using ListAlloc = MyMapAllocator<int, policy::Pool<16>>;
+        using StrAlloc  = MyMapAllocator<char, policy::Expandable<>>;
+
+        std::map<int, int, std::less<>, MapAlloc> m{MapAlloc(arena)};
+        std::forward_list<int, ListAlloc> l{ListAlloc(arena)};
+        std::basic_string<char, std::char_traits<char>, StrAlloc> s{StrAlloc(arena)};
+
+        for (int i = 0; i < 10; ++i)
+        {
+            m[i] = i;
+            l.push_front(i);
+        }
+        s.assign(100, 'x');
+
+        BOOST_CHECK(m.get_allocator().arena_handle() == arena);
+        BOOST_CHECK(l.get_allocator().arena_handle() == arena);
+
+        // Everything fits into the single shared block
+        BOOST_CHECK_EQUAL(upstream.calls, 1u);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+
+
+// ============================================================
+// Byte budgets
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(budget_charges_bytes_of_rebound_types)
+{
+    auto budget = std::make_shared<my_allocator::MemoryBudget>();
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Expandable<>>;
+    Alloc alloc;
+    alloc.set_budget(budget);
+
+    {
+        std::map<int, int, std::less<>, Alloc> m(alloc);
+        for (int i = 0; i < 10; ++i)
+            m[i] = i;
+
+        // Nodes are larger than the value type
+        BOOST_CHECK(budget->used() > 10 * sizeof(std::pair<const int, int>));
+    }
+
+    BOOST_CHECK_EQUAL(budget->used(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(budget_hierarchy_enforces_hard_and_soft_limits)
+{
+    auto process = std::make_shared<my_allocator::MemoryBudget>(1024);
+    auto tenant  = std::make_shared<my_allocator::MemoryBudget>(0, process);
+    auto request = std::make_shared<my_allocator::MemoryBudget>(512, tenant);
+
+    std::size_t soft_hits = 0;
+    tenant->set_soft_limit(256, [&](const my_allocator::MemoryBudget&) { ++soft_hits; });
+
+    MyMapAllocator<std::byte, policy::Expandable<>> a;
+    MyMapAllocator<std::byte, policy::Expandable<>> b;
+    a.set_budget(request);
+    b.set_budget(tenant);
+
+    std::byte* p = a.allocate(300);
+    BOOST_CHECK_EQUAL(soft_hits, 1u);
+    BOOST_CHECK_EQUAL(process->used(), 300u);
+
+    // Request hard limit
+    BOOST_CHECK_THROW(a.allocate(300), std::bad_alloc);
+    BOOST_CHECK_EQUAL(tenant->used(), 300u);
+
+    // Process hard limit, reached through the tenant
+    b.allocate(700);
+    BOOST_CHECK_THROW(b.allocate(100), std::bad_alloc);
+    BOOST_CHECK_EQUAL(soft_hits, 1u);
+
+    a.deallocate(p, 300);
+    BOOST_CHECK_EQUAL(request->used(), 0u);
+    BOOST_CHECK_EQUAL(process->used(), 700u);
+}
+
+BOOST_AUTO_TEST_CASE(budget_is_fixed_once_memory_is_allocated)
+{
+    auto budget = std::make_shared<my_allocator::MemoryBudget>(1024);
+
+    MyMapAllocator<std::byte, policy::Expandable<>> alloc;
+    std::byte* p = alloc.allocate(10);
+
+    // Freeing uncharged memory must not drive usage below zero
+    BOOST_CHECK_THROW(alloc.set_budget(budget), std::logic_error);
+    alloc.deallocate(p, 10);
+    BOOST_CHECK_EQUAL(budget->used(), 0u);
+
+    MyMapAllocator<std::byte, policy::Expandable<>> charged;
+    charged.set_budget(budget);
+    charged.allocate(10);
+    BOOST_CHECK_THROW(charged.set_budget(nullptr), std::logic_error);
+    BOOST_CHECK_EQUAL(budget->used(), 10u);
+
+    // Allocators on one arena with different budgets are not interchangeable
+    MyMapAllocator<std::byte, policy::Expandable<>> a(charged.arena_handle());
+    MyMapAllocator<std::byte, policy::Expandable<>> b(charged.arena_handle());
+    b.set_budget(budget);
+    BOOST_CHECK(a != b);
+    BOOST_CHECK_THROW(charged.adopt(a), std::invalid_argument);
+
+    budget->release(100);
+    BOOST_CHECK_EQUAL(budget->used(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(budget_levels_shared_between_threads)
+{
+    constexpr std::size_t Threads = 4;
+    constexpr std::size_t Rounds = 20000;
+
+    auto process = std::make_shared<my_allocator::MemoryBudget>(Threads * 64);
+    std::atomic<std::size_t> violations{0};
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < Threads; ++t)
+    {
+        workers.emplace_back([&] {
+            my_allocator::MemoryBudget request(0, process);
+
+            for (std::size_t i = 0; i < Rounds; ++i)
+            {
+                if (request.try_charge(96)) {
+                    if (process->used() > Threads * 64)
+                        violations.fetch_add(1, std::memory_order_relaxed);
+                    request.release(96);
+                } else if (request.used() != 0) {
+                    violations.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    for (auto& w : workers)
+        w.join();
+
+    BOOST_CHECK_EQUAL(violations.load(), 0u);
+    BOOST_CHECK_EQUAL(process->used(), 0u);
+}
+
+
+
+// ============================================================
+// Hybrid policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(hybrid_overflows_to_upstream_instead_of_throwing)
+{
+    CountingResource upstream;
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Hybrid<16>>;
+
+    {
+        Alloc alloc(&upstream);
+        std::map<int, int, std::less<>, Alloc> m(alloc);
+
+        for (int i = 0; i < 16; ++i)
+            m[i] = i;
+
+        BOOST_CHECK_EQUAL(upstream.calls, 0u);
+        BOOST_CHECK_EQUAL(alloc.overflows(), 0u);
+
+        for (int i = 16; i < 20; ++i)
+            m[i] = i;
+
+        BOOST_CHECK_EQUAL(alloc.overflows(), 4u);
+        BOOST_CHECK_EQUAL(upstream.calls, 4u);
+
+        // Overflow nodes go back upstream, embedded ones stay put
+        for (int i = 0; i < 20; ++i)
+            m.erase(i);
+
+        BOOST_CHECK_EQUAL(upstream.live, 0u);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+
+
+// ============================================================
+// Non-throwing allocation
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(try_allocate_reports_failure_as_nullptr)
+{
+    MyMapAllocator<int, policy::Fixed<2>> fixed;
+    BOOST_CHECK(fixed.try_allocate(2) != nullptr);
+    BOOST_CHECK(fixed.try_allocate(1) == nullptr);
+
+    MyMapAllocator<int, policy::Pool<1>> pool;
+    BOOST_CHECK(pool.try_allocate(1) != nullptr);
+    BOOST_CHECK(pool.try_allocate(1) == nullptr);
+
+    auto budget = std::make_shared<my_allocator::MemoryBudget>(64);
+    MyMapAllocator<std::byte, policy::Expandable<>> budgeted;
+    budgeted.set_budget(budget);
+    BOOST_CHECK(budgeted.try_allocate(48) != nullptr);
+    BOOST_CHECK(budgeted.try_allocate(48) == nullptr);
+    BOOST_CHECK_EQUAL(budget->used(), 48u);
+
+    alignas(std::max_align_t) std::byte buffer[64];
+    MyMapAllocator<std::byte, policy::Expandable<>> bounded(
+            std::span<std::byte>(buffer), std::pmr::null_memory_resource());
+    BOOST_CHECK(bounded.try_allocate(64) != nullptr);
+    BOOST_CHECK(bounded.try_allocate(1) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(failed_growth_keeps_current_block_out_of_tail_index)
+{
+    alignas(std::max_align_t) std::byte buffer[256];
+    MyMapAllocator<std::byte, policy::Expandable<>> alloc(
+            std::span<std::byte>(buffer), std::pmr::null_memory_resource());
+
+    std::byte* a = alloc.allocate(100);
+    BOOST_CHECK(alloc.try_allocate(200) == nullptr);
+    std::byte* b = alloc.allocate(100);
+    std::byte* c = alloc.try_allocate(60);
+
+    // The failed growth must not hand out the current block twice
+    BOOST_CHECK(b >= a + 100);
+
+    if (c)
+        BOOST_CHECK(c + 60 <= a || c >= b + 100 || (c >= a + 100 && c + 60 <= b));
+}
+
+
+BOOST_AUTO_TEST_CASE(huge_requests_fail_without_wrapping_around)
+{
+    // Read at run time, so the compiler cannot flag the constant size
+    volatile std::size_t huge_size = std::numeric_limits<std::size_t>::max() - 20;
+    const std::size_t huge = huge_size;
+
+    my_allocator::detail::Arena arena(4096);
+    BOOST_CHECK_THROW(arena.allocate_bytes(huge, 16), std::bad_alloc);
+    BOOST_CHECK(arena.try_allocate_bytes<16>(huge) == nullptr);
+
+    MyMapAllocator<int, policy::Expandable<16>> alloc;
+    const std::size_t n = std::numeric_limits<std::size_t>::max() / sizeof(int) - 1;
+    BOOST_CHECK_THROW(alloc.allocate(n), std::bad_alloc);
+    BOOST_CHECK_THROW(alloc.allocate(std::numeric_limits<std::size_t>::max() / 2), std::bad_alloc);
+    BOOST_CHECK(alloc.try_allocate(n) == nullptr);
+
+    my_allocator::ArenaResource<policy::Expandable<4096>> resource;
+    BOOST_CHECK_THROW((void)resource.allocate(huge, 16), std::bad_alloc);
+
+    // The allocator stays usable
+    BOOST_CHECK(alloc.allocate(1) != nullptr);
+}
+
+
+// ============================================================
+// Block cache
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(block_cache_recycles_blocks_between_arenas)
+{
+    CountingResource upstream;
+    my_allocator::BlockCache cache(1 << 20, false, &upstream);
+
+    for (int round = 0; round < 3; ++round)
+    {
+        MyMapAllocator<int, policy::Expandable<256>> alloc(&cache);
+        alloc.allocate(200);
+        alloc.allocate(200);
+    }
+
+    // Two blocks per round, both recycled after the first round
+    BOOST_CHECK_EQUAL(upstream.calls, 2u);
+    BOOST_CHECK_EQUAL(cache.hits(), 4u);
+
+    cache.release();
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_cache_respects_footprint_bound)
+{
+    CountingResource upstream;
+    my_allocator::BlockCache cache(1024, false, &upstream);
+
+    {
+        MyMapAllocator<std::byte, policy::Expandable<4096>> alloc(&cache);
+    }
+
+    BOOST_CHECK_EQUAL(cache.cached_bytes(), 0u);
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_cache_per_thread_subcache_flushes_on_exit)
+{
+    CountingResource upstream;
+
+    {
+        my_allocator::BlockCache cache(1 << 20, true, &upstream);
+
+        std::thread worker([&] {
+            for (int round = 0; round < 3; ++round)
+            {
+                MyMapAllocator<int, policy::Expandable<256>> alloc(&cache);
+                alloc.allocate(10);
+            }
+        });
+        worker.join();
+
+        BOOST_CHECK_EQUAL(upstream.calls, 1u);
+        BOOST_CHECK(cache.cached_bytes() > 0);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_cache_thread_slots_respect_footprint_bound)
+{
+    CountingResource upstream;
+    my_allocator::BlockCache cache(1024, true, &upstream);
+
+    void* large = cache.allocate(std::size_t{1} << 20, 64);
+    cache.deallocate(large, std::size_t{1} << 20, 64);
+
+    // Too large for the bound: returned upstream, not kept in a slot
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+
+    void* a = cache.allocate(512, 64);
+    void* b = cache.allocate(512, 64);
+    void* c = cache.allocate(512, 64);
+    cache.deallocate(a, 512, 64);
+    cache.deallocate(b, 512, 64);
+    cache.deallocate(c, 512, 64);
+
+    // Only two 512-byte blocks fit into 1024 bytes
+    BOOST_CHECK_EQUAL(upstream.live, 1024u);
+}
+
+BOOST_AUTO_TEST_CASE(block_cache_drains_slots_of_live_threads_on_destruction)
+{
+    CountingResource upstream;
+    std::atomic<int> stage{0};
+    std::thread worker;
+
+    {
+        my_allocator::BlockCache cache(1 << 20, true, &upstream);
+
+        worker = std::thread([&] {
+            void* p = cache.allocate(4096, 64);
+            cache.deallocate(p, 4096, 64);
+
+            // Keep the block parked in this thread's slot
+            stage = 1;
+            while (stage.load() != 2)
+                std::this_thread::yield();
+        });
+
+        while (stage.load() != 1)
+            std::this_thread::yield();
+
+        BOOST_CHECK_EQUAL(upstream.live, 4096u);
+    }
+
+    // Returned by the destructor, not at the thread's later exit
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+
+    stage = 2;
+    worker.join();
+}
+
+BOOST_AUTO_TEST_CASE(cached_policy_uses_global_block_cache)
+{
+    auto& cache = my_allocator::BlockCache::global();
+    const std::size_t hits = cache.hits();
+
+    for (int round = 0; round < 2; ++round)
+    {
+        using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Cached<policy::Expandable<64>>>;
+        std::map<int, int, std::less<>, Alloc> m;
+        m[round] = round;
+    }
+
+    BOOST_CHECK(cache.hits() > hits);
+}
+
+
+
+// ============================================================
+// Trimming
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(trim_releases_unused_current_block)
+{
+    CountingResource upstream;
+    my_allocator::detail::Arena arena(4096, 0, &upstream);
+
+    BOOST_CHECK(upstream.live > 0);
+    BOOST_CHECK(arena.trim() > 0);
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+
+    BOOST_REQUIRE(arena.allocate_bytes<8>(64) != nullptr);
+    BOOST_CHECK_EQUAL(arena.trim(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(trim_discards_pages_of_mmap_blocks)
+{
+    using Alloc = MyMapAllocator<std::byte, policy::Mmap<policy::Expandable<65536>>>;
+    Alloc alloc;
+
+    std::byte* p = alloc.allocate(100);
+    p[0] = std::byte{1};
+
+    if constexpr (my_allocator::detail::MmapResource::page_backed)
+        BOOST_CHECK(alloc.trim() >= 65536 - 2 * my_allocator::detail::MmapResource::page_size());
+
+    std::byte* q = alloc.allocate(30000);
+    BOOST_CHECK(q == p + 100);
+    BOOST_CHECK(p[0] == std::byte{1});
+}
+
+namespace
+{
+    template<typename Policy>
+    void check_trim_after_erase_all()
+    {
+        CountingResource upstream;
+
+        using Alloc = MyMapAllocator<std::pair<const int, int>, Policy>;
+        std::map<int, int, std::less<>, Alloc> m{Alloc(&upstream)};
+
+        for (int i = 0; i < 5000; ++i)
+            m.emplace(i, i);
+
+        BOOST_REQUIRE(upstream.live > 0);
+
+        m.clear();
+        BOOST_CHECK(m.get_allocator().trim() > 0);
+        BOOST_CHECK_EQUAL(upstream.live, 0u);
+
+        // Trimmed memory is obtained again on demand
+        for (int i = 0; i < 100; ++i)
+            m.emplace(i, i);
+
+        BOOST_CHECK_EQUAL(m.at(99), 99);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(trim_releases_free_pools_heaps_and_slabs)
+{
+    check_trim_after_erase_all<policy::Tlsf<65536>>();
+    check_trim_after_erase_all<policy::Buddy<65536, 32>>();
+    check_trim_after_erase_all<policy::Slab<128>>();
+    check_trim_after_erase_all<policy::RemoteFree<policy::Tlsf<65536>>>();
+}
+
+BOOST_AUTO_TEST_CASE(trim_discards_free_pools_inside_mmap_blocks)
+{
+    using my_allocator::detail::MmapResource;
+
+    my_allocator::detail::Arena arena(std::size_t{1} << 20, 0, MmapResource::instance());
+    my_allocator::detail::TlsfResource<65536> tlsf(arena);
+
+    void* p = tlsf.allocate(1000, 16);
+    std::memset(p, 1, 1000);
+    tlsf.deallocate(p, 1000, 16);
+
+    // The pool lives inside an arena block: its pages are dropped
+    if constexpr (MmapResource::page_backed)
+        BOOST_CHECK(tlsf.trim() >= 65536 - 2 * MmapResource::page_size());
+
+    void* q = tlsf.allocate(1000, 16);
+    BOOST_CHECK(q == p);
+}
+
+BOOST_AUTO_TEST_CASE(idle_trim_policy)
+{
+    using Alloc = MyMapAllocator<int, policy::IdleTrim<policy::Expandable<16>, 0>>;
+    Alloc alloc;
+
+    alloc.allocate(1);
+    BOOST_CHECK(alloc.trim_if_idle());
+
+    using SlowAlloc = MyMapAllocator<int, policy::IdleTrim<policy::Expandable<16>, 3600000>>;
+    SlowAlloc slow;
+
+    slow.allocate(1);
+    BOOST_CHECK(!slow.trim_if_idle());
+}
+
+
+
+// ============================================================
+// Arena adoption
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(adopted_worker_nodes_outlive_worker_map)
+{
+    CountingResource upstream;
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>, policy::Expandable<64>>;
+    using Map   = std::map<int, int, std::less<>, Alloc>;
+
+    {
+        Map result{Alloc(&upstream)};
+        result[-1] = -1;
+
+        const int* node = nullptr;
+        {
+            Map worker{Alloc(&upstream)};
+            for (int i = 0; i < 100; ++i)
+                worker[i] = i;
+            node = &worker.at(50);
+
+            BOOST_CHECK(result.get_allocator() != worker.get_allocator());
+
+            const std::size_t calls = upstream.calls;
+            result.get_allocator().adopt(worker.get_allocator());
+
+            BOOST_CHECK(result.get_allocator() == worker.get_allocator());
+            BOOST_CHECK_EQUAL(upstream.calls, calls);
+
+            result.merge(worker);
+            BOOST_CHECK(worker.empty());
+
+            // Growth of the worker now lands in the result's arena
+            Map late{worker.get_allocator()};
+            for (int i = 200; i < 300; ++i)
+                late[i] = i;
+            result.merge(late);
+        }
+
+        BOOST_CHECK_EQUAL(result.size(), 201u);
+        BOOST_CHECK(&result.at(50) == node);
+        BOOST_CHECK_EQUAL(result.at(250), 250);
+        BOOST_CHECK(upstream.live > 0);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(arena_adopt_transfers_large_allocations)
+{
+    CountingResource upstream;
+
+    {
+        my_allocator::detail::Arena a(1024, 0, &upstream);
+
+        {
+            my_allocator::detail::Arena b(1024, 0, &upstream);
+            void* big = b.allocate_bytes<8>(a.large_threshold() + 1);
+
+            a.adopt(b);
+
+            // Released through the adopting arena
+            a.deallocate_bytes(big, a.large_threshold() + 1);
+            b.allocate_bytes<8>(a.large_threshold() + 1);
+        }
+
+        BOOST_CHECK(upstream.live > 0);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+
+BOOST_AUTO_TEST_CASE(forwarding_arena_bumps_from_chunks_of_target)
+{
+    using Arena = my_allocator::detail::Arena;
+
+    CountingResource upstream;
+
+    {
+        auto target = std::make_shared<Arena>(4096, 0, &upstream);
+        Arena drained(4096, 0, &upstream);
+        drained.allocate_bytes<8>(64);
+
+        target->adopt(drained);
+        drained.forward_to(target);
+
+        auto* p = static_cast<std::byte*>(drained.allocate_bytes<8>(64));
+        target->allocate_bytes<8>(64);
+        auto* q = static_cast<std::byte*>(drained.allocate_bytes<8>(64));
+
+        // Served from a chunk of the target, not one request at a time
+        BOOST_CHECK(q == p + 64);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+
+// ============================================================
+// Per-CPU policy
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(per_cpu_allocations_from_many_threads_do_not_overlap)
+{
+    using Alloc = MyMapAllocator<std::uint64_t, policy::PerCpu<4096>>;
+    Alloc alloc;
+
+    constexpr std::size_t Threads = 8;
+    constexpr std::size_t PerThread = 2000;
+
+    std::vector<std::vector<std::uint64_t*>> ptrs(Threads);
+    std::vector<std::thread> workers;
+
+    for (std::size_t t = 0; t < Threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            Alloc local(alloc);
+            for (std::size_t i = 0; i < PerThread; ++i)
+            {
+                std::uint64_t* p = local.allocate(1 + i % 3);
+                *p = t * PerThread + i;
+                ptrs[t].push_back(p);
+            }
+        });
+    }
+
+    for (auto& w : workers)
+        w.join();
+
+    for (std::size_t t = 0; t < Threads; ++t)
+        for (std::size_t i = 0; i < PerThread; ++i)
+            BOOST_REQUIRE_EQUAL(*ptrs[t][i], t * PerThread + i);
+
+    BOOST_CHECK(alloc.resource().slot_count() >= 1u);
+}
+
+
+BOOST_AUTO_TEST_CASE(per_cpu_trim_runs_alongside_allocations)
+{
+    using Alloc = MyMapAllocator<std::uint64_t, policy::IdleTrim<policy::PerCpu<4096>, 0>>;
+    Alloc alloc;
+
+    constexpr std::size_t Threads = 4;
+    constexpr std::size_t PerThread = 2000;
+
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> corrupted{0};
+    std::vector<std::thread> workers;
+
+    for (std::size_t t = 0; t < Threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            Alloc local(alloc);
+            std::vector<std::uint64_t*> ptrs;
+
+            for (std::size_t i = 0; i < PerThread; ++i)
+            {
+                // Mix in requests served by the arena directly
+                std::uint64_t* p = local.allocate(i % 100 == 0 ? 1024 : 1);
+                *p = t * PerThread + i;
+                ptrs.push_back(p);
+            }
+
+            for (std::size_t i = 0; i < PerThread; ++i)
+                if (*ptrs[i] != t * PerThread + i)
+                    ++corrupted;
+        });
+    }
+
+    std::thread trimmer([&] {
+        while (!done.load())
+            alloc.trim_if_idle();
+    });
+
+    for (auto& w : workers)
+        w.join();
+
+    done = true;
+    trimmer.join();
+
+    BOOST_CHECK_EQUAL(corrupted.load(), 0u);
+}
+
+
+// ============================================================
+// Remote frees
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(remote_free_returns_foreign_deallocations_to_owner)
+{
+    using Alloc = MyMapAllocator<std::uint64_t, policy::RemoteFree<policy::Pool<64>>>;
+    Alloc alloc;
+
+    std::vector<std::uint64_t*> ptrs;
+    for (std::size_t i = 0; i < 64; ++i)
+        ptrs.push_back(alloc.allocate(1));
+
+    BOOST_CHECK_THROW(alloc.allocate(1), std::bad_alloc);
+
+    std::thread consumer([&] {
+        Alloc local(alloc);
+        for (std::uint64_t* p : ptrs)
+            local.deallocate(p, 1);
+    });
+    consumer.join();
+
+    BOOST_CHECK_EQUAL(alloc.resource().remote_frees(), 64u);
+
+    // The owner's next allocations reuse the drained slots
+    for (std::size_t i = 0; i < 64; ++i)
+        alloc.allocate(1);
+
+    BOOST_CHECK_THROW(alloc.allocate(1), std::bad_alloc);
+}
+
+BOOST_AUTO_TEST_CASE(remote_free_producer_consumer)
+{
+    using Alloc = MyMapAllocator<std::uint64_t, policy::RemoteFree<policy::Slab<64>>>;
+    Alloc alloc;
+
+    constexpr std::size_t Consumers = 4;
+    constexpr std::size_t Rounds = 200;
+    constexpr std::size_t Batch = 32;
+
+    for (std::size_t r = 0; r < Rounds; ++r)
+    {
+        std::vector<std::vector<std::uint64_t*>> batches(Consumers);
+
+        for (std::size_t c = 0; c < Consumers; ++c)
+            for (std::size_t i = 0; i < Batch; ++i)
+                batches[c].push_back(alloc.allocate(1));
+
+        std::vector<std::thread> consumers;
+        for (std::size_t c = 0; c < Consumers; ++c)
+        {
+            consumers.emplace_back([&, c] {
+                for (std::uint64_t* p : batches[c])
+                    alloc.deallocate(p, 1);
+            });
+        }
+
+        for (auto& t : consumers)
+            t.join();
+    }
+
+    BOOST_CHECK_EQUAL(alloc.resource().remote_frees(), Consumers * Rounds * Batch);
+
+    // Only about one round's worth of slots was ever needed
+    BOOST_CHECK(alloc.resource().inner().capacity_slots() <= 2 * Consumers * Batch);
+}
+
+
+
+// ============================================================
+// Background block provisioning
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(provisioning_swaps_in_prepared_blocks)
+{
+    my_allocator::detail::Arena arena(4096);
+    arena.enable_provisioning(0.5);
+
+    std::vector<std::uint64_t*> ptrs;
+
+    for (std::uint64_t i = 0; i < 100; ++i)
+    {
+        auto* p = static_cast<std::uint64_t*>(arena.allocate_bytes<8>(512));
+        *p = i;
+        ptrs.push_back(p);
+
+        // Give the worker time to prepare the next block
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (std::uint64_t i = 0; i < 100; ++i)
+        BOOST_REQUIRE_EQUAL(*ptrs[i], i);
+
+    BOOST_CHECK(arena.provisioned_blocks() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(provisioning_keeps_fill_mark_transparent)
+{
+    my_allocator::detail::Arena arena(4096);
+    arena.enable_provisioning(0.25);
+
+    // Non-growing allocations may pass the fill mark
+    std::size_t served = 0;
+    while (arena.try_allocate_bytes<8>(256))
+        ++served;
+
+    BOOST_CHECK(served >= 4096 / 256 - 1);
+}
+
+BOOST_AUTO_TEST_CASE(provisioning_adapts_to_oversized_growth)
+{
+    // Every growth needs more than block_size, as with node-sized
+    // policies such as Expandable<2>
+    my_allocator::detail::Arena arena(64);
+    arena.enable_provisioning(0.5);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        arena.allocate_bytes<8>(512);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    BOOST_CHECK(arena.provisioned_blocks() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(trim_releases_prepared_block)
+{
+    // Used from the worker thread as well
+    struct SharedCountingResource : std::pmr::memory_resource
+    {
+        std::atomic<std::size_t> live{0};
+
+        void* do_allocate(std::size_t bytes, std::size_t align) override
+        {
+            live += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+        {
+            live -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    } upstream;
+
+    {
+        my_allocator::detail::Arena arena(4096, 0, &upstream);
+        const std::size_t one_block = upstream.live;
+
+        arena.enable_provisioning(0.5);
+
+        // Passes the fill mark without growing
+        arena.allocate_bytes<8>(3000);
+
+        for (int i = 0; i < 1000 && upstream.live == one_block; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        const std::size_t prepared = upstream.live - one_block;
+        BOOST_REQUIRE(prepared > 0);
+
+        BOOST_CHECK(arena.trim() >= prepared);
+        BOOST_CHECK_EQUAL(upstream.live.load(), one_block);
+
+        // Provisioning resumes after the next growth
+        for (int i = 0; i < 100 && arena.provisioned_blocks() == 0; ++i)
+        {
+            arena.allocate_bytes<8>(512);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        BOOST_CHECK(arena.provisioned_blocks() > 0);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live.load(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(provisioning_shares_one_worker_thread)
+{
+    auto threads = [] {
+        const std::filesystem::directory_iterator tasks("/proc/self/task");
+        return std::distance(begin(tasks), end(tasks));
+    };
+
+    const auto before = threads();
+
+    std::vector<std::unique_ptr<my_allocator::detail::Arena>> arenas;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        arenas.push_back(std::make_unique<my_allocator::detail::Arena>(4096));
+        arenas.back()->enable_provisioning();
+    }
+
+    BOOST_CHECK(threads() <= before + 1);
+}
+
+BOOST_AUTO_TEST_CASE(provisioned_policy_with_map)
+{
+    using Policy = policy::Provisioned<policy::Expandable<64>, 75>;
+    using Alloc = MyMapAllocator<std::pair<const int, int>, Policy>;
+
+    std::map<int, int, std::less<>, Alloc> m;
+
+    for (int i = 0; i < 10000; ++i)
+        m.emplace(i, i * 2);
+
+    BOOST_CHECK_EQUAL(m.size(), 10000u);
+    BOOST_CHECK_EQUAL(m.at(9999), 19998);
+
+    my_allocator::ArenaResource<Policy> resource;
+    std::pmr::vector<int> v(&resource);
+    v.resize(1000, 7);
+    BOOST_CHECK_EQUAL(v.back(), 7);
+}
+
+
+
+// ============================================================
+// Block coloring
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(coloring_staggers_block_starts)
+{
+    using Arena = my_allocator::detail::Arena;
+
+    const std::size_t page = my_allocator::detail::MmapResource::page_size();
+
+    std::vector<std::unique_ptr<Arena>> arenas;
+    std::vector<std::uintptr_t> offsets;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto& arena = arenas.emplace_back(
+                std::make_unique<Arena>(16384, 0, my_allocator::detail::MmapResource::instance()));
+        arena->enable_coloring();
+
+        offsets.push_back(reinterpret_cast<std::uintptr_t>(arena->allocate_bytes<8>(8)) % page);
+    }
+
+    // Page-aligned blocks start at different cache lines...
+    std::vector<std::uintptr_t> distinct(offsets);
+    std::sort(distinct.begin(), distinct.end());
+    BOOST_CHECK(std::unique(distinct.begin(), distinct.end()) - distinct.begin() > 1);
+
+    // ...shifted by whole cache lines
+    for (std::uintptr_t offset : offsets)
+        BOOST_CHECK_EQUAL(offset % Arena::cache_line, offsets.front() % Arena::cache_line);
+}
+
+BOOST_AUTO_TEST_CASE(coloring_keeps_blocks_usable_and_trimmable)
+{
+    CountingResource upstream;
+
+    {
+        my_allocator::detail::Arena arena(4096, 0, &upstream);
+        arena.enable_coloring();
+
+        // An untouched colored block is released by trim()
+        BOOST_CHECK(arena.trim() > 0);
+        BOOST_CHECK_EQUAL(upstream.live, 0u);
+
+        // Grown blocks still fit the request that triggered them
+        for (int i = 0; i < 50; ++i)
+            BOOST_CHECK(arena.allocate_bytes<8>(4000) != nullptr);
+    }
+
+    BOOST_CHECK_EQUAL(upstream.live, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(colored_policy_spreads_first_nodes)
+{
+    using Alloc = MyMapAllocator<std::pair<const int, int>,
+                                 policy::Colored<policy::Mmap<policy::Expandable<256>>>>;
+
+    const std::size_t page = my_allocator::detail::MmapResource::page_size();
+
+    std::vector<std::map<int, int, std::less<>, Alloc>> maps(8);
+    std::vector<std::uintptr_t> offsets;
+
+    for (auto& m : maps)
+    {
+        m.emplace(1, 1);
+        offsets.push_back(reinterpret_cast<std::uintptr_t>(&*m.begin()) % page);
+    }
+
+    std::sort(offsets.begin(), offsets.end());
+    BOOST_CHECK(std::unique(offsets.begin(), offsets.end()) - offsets.begin() > 1);
+
+    for (auto& m : maps)
+        BOOST_CHECK_EQUAL(m.at(1), 1);
+}
+
+
+
+// ============================================================
+// Cache-line isolation
+// ============================================================
+
+BOOST_AUTO_TEST_CASE(line_isolated_nodes_never_share_cache_lines)
+{
+    using Alloc = MyMapAllocator<std::uint64_t, policy::LineIsolated<policy::Expandable<64>>>;
+    Alloc alloc;
+
+    std::vector<std::uintptr_t> lines;
+
+    for (int i = 0; i < 200; ++i)
+    {
+        const auto p = reinterpret_cast<std::uintptr_t>(alloc.allocate(1));
+        BOOST_REQUIRE_EQUAL(p % 64, 0u);
+        lines.push_back(p / 64);
+    }
+
+    std::sort(lines.begin(), lines.end());
+    BOOST_CHECK(std::adjacent_find(lines.begin(), lines.end()) == lines.end());
+}
+
+BOOST_AUTO_TEST_CASE(line_isolated_counters_updated_concurrently)
+{
+    using Alloc = MyMapAllocator<std::pair<const int, std::uint64_t>,
+                                 policy::LineIsolated<policy::Slab<64>>>;
+
+    constexpr int Threads = 4;
+    constexpr std::uint64_t Increments = 100000;
+
+    std::map<int, std::uint64_t, std::less<>, Alloc> counters;
+    for (int t = 0; t < Threads; ++t)
+        counters.emplace(t, 0);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < Threads; ++t)
+    {
+        workers.emplace_back([&counters, t] {
+            std::uint64_t& counter = counters.find(t)->second;
+            for (std::uint64_t i = 0; i < Increments; ++i)
+                ++counter;
+        });
+    }
+
+    for (auto& w : workers)
+        w.join();
+
+    for (int t = 0; t < Threads; ++t)
+        BOOST_CHECK_EQUAL(counters.at(t), Increments);
+}
+
+BOOST_AUTO_TEST_CASE(line_isolated_tlsf_keeps_reusing_memory)
+{
+    CountingResource upstream;
+
+    using Alloc = MyMapAllocator<std::pair<const int, int>,
+                                 policy::LineIsolated<policy::Tlsf<>>>;
+    Alloc alloc(&upstream);
+
+    {
+        std::map<int, int, std::less<>, Alloc> m(alloc);
+
+        for (int round = 0; round < 200; ++round)
+        {
+            for (int i = 0; i < 100; ++i)
+                m.emplace(i, i);
+
+            m.clear();
+        }
+    }
+
+    // One TLSF pool serves every round
+    BOOST_CHECK(upstream.live < 2 * 65536);
+}
+
+BOOST_AUTO_TEST_CASE(tlsf_serves_cache_line_alignment_from_pools)
+{
+    CountingResource upstream;
+    my_allocator::detail::Arena arena(0, 0, &upstream);
+    my_allocator::detail::TlsfResource<4096> tlsf(arena);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 20; ++i)
+    {
+        void* p = tlsf.allocate(24 + i, i % 2 ? 64 : 16);
+        BOOST_REQUIRE_EQUAL(reinterpret_cast<std::uintptr_t>(p) % (i % 2 ? 64 : 16), 0u);
+        std::memset(p, 0xAB, 24 + i);
+        ptrs.push_back(p);
+    }
+
+    for (int i = 0; i < 20; ++i)
+        tlsf.deallocate(ptrs[i], 24 + i, i % 2 ? 64 : 16);
+
+    // Everything coalesced: a maximal request fits the same pool again
+    const std::size_t calls = upstream.calls;
+    void* big = tlsf.allocate(1024, 64);
+    BOOST_CHECK_EQUAL(upstream.calls, calls);
+    tlsf.deallocate(big, 1024, 64);
+}
+
+BOOST_AUTO_TEST_CASE(line_isolated_hybrid_keeps_capacity_embedded)
+{
+    using Alloc = MyMapAllocator<std::pair<const int, int>,
+                                 policy::LineIsolated<policy::Hybrid<16>>>;
+    Alloc alloc;
+
+    std::map<int, int, std::less<>, Alloc> m(alloc);
+    for (int i = 0; i < 16; ++i)
+        m.emplace(i, i);
+
+    BOOST_CHECK_EQUAL(alloc.overflows(), 0u);
+}
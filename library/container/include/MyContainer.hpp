@@ -5,6 +5,8 @@
 #include <cstddef>
 #include <utility>
 #include <cassert>
+#include <concepts>
+#include <new>
 
 /**
  * @brief Singly-linked container with allocator support
@@ -260,6 +262,51 @@ public:
         ++size_;
     }
 
+    /**
+     * @brief Inserts an element at the back without throwing on
+     *        allocation failure
+     *
+     * @param value Value to insert
+     *
+     * @return false if node memory could not be allocated
+     *         (the container is left unchanged)
+     */
+    [[nodiscard]] bool try_push_back(const T& value) {
+        return try_emplace_back(value);
+    }
+
+    /**
+     * @brief Constructs an element in place at the back without
+     *        throwing on allocation failure
+     *
+     * Uses the allocator's try_allocate() when available, so rejecting
+     * work when a pool or budget is exhausted costs no exception.
+     * Exceptions thrown by the element constructor are propagated.
+     *
+     * @param args Arguments forwarded to T constructor
+     *
+     * @return false if node memory could not be allocated
+     *         (the container is left unchanged)
+     */
+    template<typename... Args>
+    [[nodiscard]] bool try_emplace_back(Args&&... args) {
+        node_pointer n = try_create_node(std::forward<Args>(args)...);
+
+        if (!n)
+            return false;
+
+        std::to_address(n)->next = sentinel_ptr_;
+
+        if (empty()) {
+            head_ = tail_ = n;
+        } else {
+            std::to_address(tail_)->next = n;
+            tail_ = n;
+        }
+        ++size_;
+        return true;
+    }
+
     /**
      * @brief Removes the first element
      *
@@ -456,6 +503,45 @@ private:
         return p;
     }
 
+    /**
+     * @brief Allocates and constructs a node, reporting allocation
+     *        failure as nullptr
+     *
+     * @tparam Args Constructor argument types
+     * @param args Arguments forwarded to T constructor
+     *
+     * @return Pointer to newly created node, or nullptr if allocation
+     *         failed
+     *
+     * @throws Propagates exceptions from construction
+     */
+    template<typename... Args>
+    node_pointer try_create_node(Args&&... args) {
+        node_pointer p{};
+
+        if constexpr (requires { { node_alloc_.try_allocate(std::size_t{1}) } -> std::convertible_to<node_pointer>; }) {
+            p = node_alloc_.try_allocate(1);
+        } else {
+            try {
+                p = node_traits_t::allocate(node_alloc_, 1);
+            } catch (const std::bad_alloc&) {
+                return nullptr;
+            }
+        }
+
+        if (!p)
+            return nullptr;
+
+        Node* raw = std::to_address(p);
+        try {
+            node_traits_t::construct(node_alloc_, raw, node_pointer{}, std::forward<Args>(args)...);
+        } catch (...) {
+            node_traits_t::deallocate(node_alloc_, p, 1);
+            throw;
+        }
+        return p;
+    }
+
     /**
      * @brief Destroys and deallocates a node
      *
@@ -306,4 +306,31 @@ BOOST_AUTO_TEST_SUITE(mycontainer_with_myallocator)
         BOOST_CHECK(c.empty());
     }
 
+    BOOST_AUTO_TEST_CASE(fixed_capacity_try_push_back_rejects)
+    {
+        using Alloc = MyMapAllocator<int, policy::Fixed<3>>;
+        MyContainer<int, Alloc> c;
+
+        BOOST_CHECK(c.try_push_back(1));
+        BOOST_CHECK(c.try_emplace_back(2));
+        BOOST_CHECK(c.try_push_back(3));
+
+        BOOST_CHECK(!c.try_push_back(4));
+        BOOST_CHECK_EQUAL(c.size(), 3u);
+    }
+
+    BOOST_AUTO_TEST_CASE(pool_try_emplace_back_rejects_when_full)
+    {
+        using Alloc = MyMapAllocator<int, policy::Pool<2>>;
+        MyContainer<int, Alloc> c;
+
+        BOOST_CHECK(c.try_emplace_back(1));
+        BOOST_CHECK(c.try_emplace_back(2));
+        BOOST_CHECK(!c.try_emplace_back(3));
+
+        c.pop_front();
+        BOOST_CHECK(c.try_emplace_back(3));
+        BOOST_CHECK_EQUAL(c.size(), 2u);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()